@@ -92,6 +92,173 @@
     }
   },
 
+  //
+  // Log profiles: decimation of each log group (0 = not logged, 1 = every
+  // cycle, N = every N cycles). Groups missing from a profile are logged at
+  // every cycle. Labels of the "segment_label" column are written to
+  // capture_walking-segment-labels-<timestamp>.csv in the
+  // "segment_labels_directory", with the timestamp of the run's change log.
+  //
+
+  "log":
+  {
+    "segment_labels_directory": "/tmp",
+    "profile": "full",
+    "profiles":
+    {
+      "full": {},
+      "production":
+      {
+        "budget": 1,
+        "controlRobot": 0,
+        "errors": 1,
+        "estimator": 5,
+        "pendulum": 1,
+        "realRobot": 0,
+        "stabilizer": 1,
+        "stabilizer_qp": 0,
+        "stabilizer_vfc": 10,
+        "wpg": 5
+      }
+    }
+  },
+
+  //
+  // Change log of rarely-changing parameters (plan, HMPC weights, stabilizer
+  // gains), written to <directory>/capture_walking-changes-<date>.csv
+  //
+
+  "changelog":
+  {
+    "enabled": true,
+    "directory": "/tmp",
+    "period": 0.1               // [s] between two polls of parameter values
+  },
+
+  //
+  // Preview updates: "periodic" or "event" triggered
+  //
+
+  "preview_trigger":
+  {
+    "mode": "periodic",
+    "dcm_error": 0.02,          // [m] horizontal DCM tracking error
+    "zmp_margin": 0.01,         // [m] reference ZMP to support area boundary
+    "contact_drift": 0.01,      // [m] planned to measured support contacts
+    "max_period": 0.4           // [s] fallback period between updates
+  },
+
+  //
+  // Speculative solve of double-support previews during single support
+  //
+
+  "presolve":
+  {
+    "enabled": true,
+    "window": 0.15,             // [s] before end of single support
+    "max_com_error": 0.01,      // [m] between predicted and actual CoM
+    "max_comd_error": 0.05,     // [m] / [s] same for CoM velocity
+    "max_comdd_error": 0.5,     // [m] / [s]^2 same for CoM acceleration (HMPC only)
+    "max_contact_error": 0.01   // [m] between predicted and actual contacts
+  },
+
+  //
+  // Shared-memory telemetry, read by tools/telemetry_reader
+  //
+
+  "telemetry":
+  {
+    "enabled": true,
+    "segment": "/capture_walking_telemetry",
+    "capacity": 4000            // number of control cycles kept in the ring
+  },
+
+  //
+  // Chrome/Perfetto trace file, only written when built with the
+  // CAPTURE_WALKING_TRACING option
+  //
+
+  "tracing":
+  {
+    "file": "/tmp/capture_walking-trace.json"
+  },
+
+  //
+  // Socket receiving upcoming footsteps of plans with "streaming": true, e.g.
+  // from tools/footstep_producer
+  //
+
+  "footstep_stream":
+  {
+    "enabled": true,
+    "socket": "/tmp/capture_walking_footsteps.sock"
+  },
+
+  //
+  // Heap allocation audit, only active when the control loop is run with
+  // LD_PRELOAD=libcapture_walking_controller_alloc_audit.so
+  //
+
+  "allocation_audit":
+  {
+    "strict": false,            // fail when a steady-state walking cycle allocates
+    "steady_states": ["DoubleSupport", "SingleSupport"]
+  },
+
+  //
+  // Precompiled footstep plans, written by tools/plan_compiler at build time.
+  // Plans that are not in the library, or changed since it was compiled, are
+  // read from the "plans" section
+  //
+
+  "plan_library":
+  {
+    "enabled": true,
+    "file": "@CAPTURE_WALKING_PLAN_LIBRARY@"
+  },
+
+  //
+  // Feasibility pre-check of all steps of a plan when it is loaded. Nominal
+  // solutions are reused when a double-support phase starts near them
+  //
+
+  "plan_validation":
+  {
+    "enabled": true,
+    "threads": 0,               // zero to use all cores
+    "verbose": false            // report feasible steps as well
+  },
+
+  //
+  // Memory locking at startup and dummy solves of the first step in the
+  // Initial state, so that the first walking cycles do not pay cold-start costs
+  //
+
+  "warmup":
+  {
+    "enabled": true,
+    "lock_memory": true,        // needs CAP_IPC_LOCK or a high RLIMIT_MEMLOCK
+    "solves": 3,                // per solver, one solve per cycle
+    "stack_prefault": 524288    // [bytes]
+  },
+
+  //
+  // CPU affinity and scheduling of auxiliary threads. Schedulers are "other",
+  // "batch", "idle", "fifo" or "rr"; priorities only apply to the last two and
+  // should stay below that of the control thread
+  //
+
+  "threads":
+  {
+    "isolate_from_control": true,
+    "control_cpus": [],         // empty for the CPUs the controller thread is pinned to
+    "deferred_log": {"scheduler": "batch"},
+    "plan_validator": {"scheduler": "batch"},
+    "presolver": {"scheduler": "other"},
+    "spinner": {"scheduler": "batch"},
+    "tracer": {"scheduler": "batch"}
+  },
+
   //
   // Sole dimensions for HRP-4
   //
@@ -339,6 +506,19 @@
         { "pose": { "translation": [1.0,  0.09, 0.0] }, "ref_vel": [0.0,  0.0, 0.0], "surface": "LeftFootCenter" }
       ]
     },
+    "streaming":
+    {
+      "com_height": 0.78,
+      "double_support_duration": 0.2,
+      "single_support_duration": 0.8,
+      "swing_height": 0.04,
+      "streaming": true,        // upcoming contacts are received from footstep_stream
+      "contacts":
+      [
+        { "pose": { "translation": [0.0, -0.09, 0.0] }, "surface": "RightFootCenter" },
+        { "pose": { "translation": [0.0,  0.09, 0.0] }, "surface": "LeftFootCenter" }
+      ]
+    },
     "straight_15cm_steps":
     {
       "com_height": 0.78,
@@ -82,6 +82,15 @@ namespace capture_walking
      */
     bool solve();
 
+    /** Get intervals of feasible values for the external parameter alpha,
+     * as computed by the last call to solve().
+     *
+     */
+    inline const std::vector<Interval> & alphaIntervals() const
+    {
+      return alphaIntervals_;
+    }
+
     /** Get the vector of discretized square differences.
      *
      */
@@ -157,6 +166,14 @@ namespace capture_walking
       return solution_;
     }
 
+    /** Get solver status for the last call to CPS.
+     *
+     */
+    inline cps::SolverStatus status() const
+    {
+      return status_;
+    }
+
     /** Set desired step time.
      *
      * \param desiredStepTime Time of contact switch.
@@ -266,8 +283,8 @@ namespace capture_walking
     {
       Eigen::Vector3d cop = contact.anklePos();
       cop += ankleToTargetCoP.x() * contact.t();
-      double sign = (contact.surfaceName == "LeftFootCenter") ? -1. :
-        (contact.surfaceName == "RightFootCenter") ? +1. : 0.;
+      double sign = (contact.surface == ContactSurface::LeftFootCenter) ? -1. :
+        (contact.surface == ContactSurface::RightFootCenter) ? +1. : 0.;
       cop += sign * ankleToTargetCoP.y() * contact.b();
       return cop;
     }
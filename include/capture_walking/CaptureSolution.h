@@ -184,6 +184,18 @@ namespace capture_walking
      */
     void integratePostPlayback(Pendulum & state, double dt);
 
+    /** Sample the reference over the solution horizon.
+     *
+     * \param state Initial CoM state.
+     *
+     * \param dt Sampling period, normally the controller timestep.
+     *
+     * Fills the lookahead buffer so that subsequent calls to integrate() with
+     * the same timestep become table lookups.
+     *
+     */
+    void sample(const Pendulum & state, double dt);
+
     /** Get the damping value for a given time.
      *
      * \param t Time, zero being the beginning of the solution.
@@ -208,6 +220,20 @@ namespace capture_walking
     }
 
   private:
+    /** Precompute per-segment constants after phi and lambda are updated.
+     *
+     */
+    void computeSegmentConstants();
+
+    /** Integrate one step of the analytical solution.
+     *
+     * \param state CoM state to integrate upon.
+     *
+     * \param dt Duration.
+     *
+     */
+    void integrateSolution(Pendulum & state, double dt);
+
     /** Get the DCM frequency for a given time.
      *
      * \param t Time, zero being the beginning of the solution.
@@ -234,8 +260,15 @@ namespace capture_walking
     unsigned nbSteps;
 
   private:
-    bool playbackIsOver_ = false;
     double cost_ = 1e5;
     double stepTime_ = -1.;
+    std::vector<double> segmentOmega_; // omega_j of time segment j
+    std::vector<double> segmentSqrtLambda_; // sqrt(lambda) of time segment j
+    std::vector<double> sqrtLambda_; // sqrt(lambda[j]) of spatial segment j
+    std::vector<double> sqrtPhi_; // sqrt(phi[j])
+    std::vector<double> tFromSNum_; // numerator of tFromS() on spatial segment j
+    unsigned phiCursor_ = 0;
+    unsigned sCursor_ = 0;
+    unsigned timeCursor_ = 0;
   };
 }
@@ -27,11 +27,17 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
 
 #include <mc_tasks/CoPTask.h>
 
 #include <capture_walking/defs.h>
+#include <capture_walking/utils/DeferredLog.h>
 
 namespace capture_walking
 {
@@ -46,7 +52,103 @@ namespace capture_walking
     Flying
   };
 
+  /** Robot surfaces that contacts can be made with.
+   *
+   */
+  enum class ContactSurface : uint8_t
+  {
+    Unknown,
+    LeftFootCenter,
+    RightFootCenter
+  };
+
+  /** Get surface from its name in the robot model.
+   *
+   * \param name Surface name.
+   *
+   */
+  inline ContactSurface contactSurfaceFromName(const std::string & name)
+  {
+    if (name == "LeftFootCenter")
+    {
+      return ContactSurface::LeftFootCenter;
+    }
+    else if (name == "RightFootCenter")
+    {
+      return ContactSurface::RightFootCenter;
+    }
+    return ContactSurface::Unknown;
+  }
+
+  /** Get name of a surface in the robot model.
+   *
+   * \param surface Contact surface.
+   *
+   */
+  inline const char * contactSurfaceName(ContactSurface surface)
+  {
+    switch (surface)
+    {
+      case ContactSurface::LeftFootCenter:
+        return "LeftFootCenter";
+      case ContactSurface::RightFootCenter:
+        return "RightFootCenter";
+      default:
+        return "";
+    }
+  }
+
+  /** Swing foot parameters overriding plan defaults for a given step.
+   *
+   * Parameters are NaN when they are not overridden.
+   *
+   */
+  struct SwingParams
+  {
+    /** Check whether a parameter is overridden.
+     *
+     * \param value Parameter value.
+     *
+     */
+    static bool isSet(double value)
+    {
+      return !std::isnan(value);
+    }
+
+    double height = std::numeric_limits<double>::quiet_NaN(); // [m]
+    double landingPitch = std::numeric_limits<double>::quiet_NaN(); // [rad]
+    double landingRatio = std::numeric_limits<double>::quiet_NaN();
+    double takeoffPitch = std::numeric_limits<double>::quiet_NaN(); // [rad]
+    double takeoffRatio = std::numeric_limits<double>::quiet_NaN();
+    Eigen::Vector3d takeoffOffset = Eigen::Vector3d::Constant(std::numeric_limits<double>::quiet_NaN()); // [m]
+  };
+
+  /** Plan-dependent quantities used by previews, precomputed once per
+   * contact by Contact::updateGeometry().
+   *
+   */
+  struct ContactGeometry
+  {
+    /** Apply a translation to the world-frame quantities.
+     *
+     * \param offset Translation vector in world frame.
+     *
+     */
+    void translate(const Eigen::Vector3d & offset)
+    {
+      hrepVec += hrepMat * offset.head<2>();
+      anklePos += offset;
+    }
+
+    Eigen::Matrix<double, 4, 2, Eigen::DontAlign> hrepMat = Eigen::Matrix<double, 4, 2, Eigen::DontAlign>::Zero(); // world-frame ZMP halfspaces
+    Eigen::Matrix<double, 4, 1, Eigen::DontAlign> hrepVec = Eigen::Matrix<double, 4, 1, Eigen::DontAlign>::Zero();
+    Eigen::Vector3d anklePos = Eigen::Vector3d::Zero(); // [m]
+    bool isHorizontal = true;
+  };
+
   /** Contacts wrap foot frames with extra info from the footstep plan.
+   *
+   * Contacts only hold plain data, so that copying them does not allocate.
    *
    */
   struct Contact
@@ -60,7 +162,6 @@ namespace capture_walking
       : refVel({0., 0., 0.}),
         halfLength(0.),
         halfWidth(0.),
-        surfaceName(""),
         pose(),
         id(0)
     {
@@ -75,7 +176,6 @@ namespace capture_walking
       : refVel({0., 0., 0.}),
         halfLength(0.),
         halfWidth(0.),
-        surfaceName(""),
         pose(pose),
         id(0)
     {
@@ -150,18 +250,15 @@ namespace capture_walking
      */
     inline Eigen::Vector3d anklePos() const
     {
-      if (surfaceName == "LeftFootCenter")
-      {
-        return p() - 0.015 * t() - 0.01 * b();
-      }
-      else if (surfaceName == "RightFootCenter")
+      switch (surface)
       {
-        return p() - 0.015 * t() + 0.01 * b();
-      }
-      else
-      {
-        LOG_ERROR("Cannot compute anklePos for surface " << surfaceName);
-        return p();
+        case ContactSurface::LeftFootCenter:
+          return p() - 0.015 * t() - 0.01 * b();
+        case ContactSurface::RightFootCenter:
+          return p() - 0.015 * t() + 0.01 * b();
+        default:
+          CW_LOG_ERROR("Cannot compute anklePos for unknown contact surface");
+          return p();
       }
     }
 
@@ -173,6 +270,44 @@ namespace capture_walking
       return {pose.rotation(), anklePos()};
     }
 
+    /** Name of the contact surface in the robot model.
+     *
+     */
+    inline const char * surfaceName() const
+    {
+      return contactSurfaceName(surface);
+    }
+
+    /** Translate contact frame along with its precomputed geometry.
+     *
+     * \param offset Translation vector in contact frame.
+     *
+     */
+    inline void translate(const Eigen::Vector3d & offset)
+    {
+      pose = sva::PTransformd(offset) * pose;
+      geometry.translate(pose.rotation().transpose() * offset);
+    }
+
+    /** Precompute ZMP halfspaces, ankle position and horizontality of the
+     * contact from its pose and dimensions.
+     *
+     */
+    inline void updateGeometry()
+    {
+      Eigen::Matrix<double, 4, 2> localHrepMat;
+      localHrepMat <<
+        +1, 0,
+        -1, 0,
+        0, +1,
+        0, -1;
+      Eigen::Vector4d localHrepVec = {halfLength, halfLength, halfWidth, halfWidth};
+      geometry.hrepMat = localHrepMat * pose.rotation().topLeftCorner<2, 2>();
+      geometry.hrepVec = geometry.hrepMat * pose.translation().head<2>() + localHrepVec;
+      geometry.anklePos = (surface != ContactSurface::Unknown) ? anklePos() : p();
+      geometry.isHorizontal = ((normal() - world::e_z).norm() <= 1e-3);
+    }
+
     /** Shorthand for world x-coordinate.
      *
      */
@@ -229,6 +364,22 @@ namespace capture_walking
       return position() - halfLength * t() + halfWidth * b();
     }
 
+    /** Distance from a point to the boundary of the contact area.
+     *
+     * \param point Point, projected on the contact plane.
+     *
+     * \returns Distance, positive if the point lies inside the area and
+     * negative otherwise.
+     *
+     */
+    inline double margin(const Eigen::Vector3d & point) const
+    {
+      Eigen::Vector3d offset = point - position();
+      double xMargin = halfLength - std::abs(t().dot(offset));
+      double yMargin = halfWidth - std::abs(b().dot(offset));
+      return std::min(xMargin, yMargin);
+    }
+
     /** Minimum coordinate for vertices of the contact area.
      *
      */
@@ -305,17 +456,18 @@ namespace capture_walking
       Contact noisedContact = *this;
       Eigen::Vector3d unitRandom = Eigen::Vector3d::Random().normalized();
       Eigen::Vector3d displacement = magnitude * unitRandom;
-      noisedContact.pose = sva::PTransformd{displacement} * this->pose;
+      noisedContact.translate(displacement);
       return noisedContact;
     }
 
   public:
     Eigen::Vector3d refVel;
     bool pauseAfterSwing = false;
+    ContactGeometry geometry;
+    ContactSurface surface = ContactSurface::Unknown;
+    SwingParams swing;
     double halfLength;
     double halfWidth;
-    mc_rtc::Configuration swingConfig;
-    std::string surfaceName;
     sva::PTransformd pose;
     unsigned id;
   };
@@ -331,12 +483,116 @@ namespace capture_walking
   {
     Contact result = contact;
     result.pose = X * contact.pose;
+    result.updateGeometry();
     return result;
   }
+
+  /** Distance from a point to the boundary of the horizontal convex hull of
+   * two contact areas, i.e. of the support area in double support.
+   *
+   * \param left First contact.
+   *
+   * \param right Second contact.
+   *
+   * \param point Point, projected on the horizontal plane.
+   *
+   * \returns Distance, positive if the point lies inside the hull and
+   * negative otherwise.
+   *
+   */
+  inline double doubleSupportMargin(const Contact & left, const Contact & right, const Eigen::Vector3d & point)
+  {
+    std::array<Eigen::Vector2d, 8> vertices = {{
+      left.vertex0().head<2>(), left.vertex1().head<2>(), left.vertex2().head<2>(), left.vertex3().head<2>(),
+      right.vertex0().head<2>(), right.vertex1().head<2>(), right.vertex2().head<2>(), right.vertex3().head<2>()}};
+    std::sort(vertices.begin(), vertices.end(),
+      [](const Eigen::Vector2d & a, const Eigen::Vector2d & b) { return (a.x() < b.x()) || (a.x() == b.x() && a.y() < b.y()); });
+    auto cross = [](const Eigen::Vector2d & o, const Eigen::Vector2d & a, const Eigen::Vector2d & b)
+    {
+      return (a.x() - o.x()) * (b.y() - o.y()) - (a.y() - o.y()) * (b.x() - o.x());
+    };
+
+    // Andrew's monotone chain, counterclockwise with hull[k - 1] == hull[0]
+    std::array<Eigen::Vector2d, 2 * 8> hull;
+    unsigned k = 0;
+    for (unsigned i = 0; i < 8; i++)
+    {
+      while (k >= 2 && cross(hull[k - 2], hull[k - 1], vertices[i]) <= 0.)
+      {
+        k--;
+      }
+      hull[k++] = vertices[i];
+    }
+    for (unsigned i = 7, lowerSize = k + 1; i-- > 0;)
+    {
+      while (k >= lowerSize && cross(hull[k - 2], hull[k - 1], vertices[i]) <= 0.)
+      {
+        k--;
+      }
+      hull[k++] = vertices[i];
+    }
+
+    Eigen::Vector2d p = point.head<2>();
+    double margin = std::numeric_limits<double>::infinity();
+    for (unsigned i = 0; i + 1 < k; i++)
+    {
+      Eigen::Vector2d edge = hull[i + 1] - hull[i];
+      Eigen::Vector2d inward = Eigen::Vector2d{-edge.y(), edge.x()} / edge.norm();
+      margin = std::min(margin, inward.dot(p - hull[i]));
+    }
+    return margin;
+  }
 }
 
 namespace mc_rtc
 {
+  template<>
+  struct ConfigurationLoader<capture_walking::SwingParams>
+  {
+    static capture_walking::SwingParams load(const mc_rtc::Configuration & config)
+    {
+      capture_walking::SwingParams swing;
+      config("height", swing.height);
+      config("landing_pitch", swing.landingPitch);
+      config("landing_ratio", swing.landingRatio);
+      config("takeoff_offset", swing.takeoffOffset);
+      config("takeoff_pitch", swing.takeoffPitch);
+      config("takeoff_ratio", swing.takeoffRatio);
+      return swing;
+    }
+
+    static mc_rtc::Configuration save(const capture_walking::SwingParams & swing)
+    {
+      using capture_walking::SwingParams;
+      mc_rtc::Configuration config;
+      if (SwingParams::isSet(swing.height))
+      {
+        config.add("height", swing.height);
+      }
+      if (SwingParams::isSet(swing.landingPitch))
+      {
+        config.add("landing_pitch", swing.landingPitch);
+      }
+      if (SwingParams::isSet(swing.landingRatio))
+      {
+        config.add("landing_ratio", swing.landingRatio);
+      }
+      if (SwingParams::isSet(swing.takeoffOffset.x()))
+      {
+        config.add("takeoff_offset", swing.takeoffOffset);
+      }
+      if (SwingParams::isSet(swing.takeoffPitch))
+      {
+        config.add("takeoff_pitch", swing.takeoffPitch);
+      }
+      if (SwingParams::isSet(swing.takeoffRatio))
+      {
+        config.add("takeoff_ratio", swing.takeoffRatio);
+      }
+      return config;
+    }
+  };
+
   template<>
   struct ConfigurationLoader<capture_walking::Contact>
   {
@@ -347,14 +603,16 @@ namespace mc_rtc
       config("half_length", contact.halfLength);
       config("half_width", contact.halfWidth);
       config("ref_vel", contact.refVel);
-      config("surface", contact.surfaceName);
+      std::string surfaceName = "";
+      config("surface", surfaceName);
+      contact.surface = capture_walking::contactSurfaceFromName(surfaceName);
       if (config.has("pause_after_swing"))
       {
         contact.pauseAfterSwing = config("pause_after_swing");
       }
       if (config.has("swing"))
       {
-        contact.swingConfig = config("swing");
+        contact.swing = config("swing");
       }
       return contact;
     }
@@ -366,14 +624,15 @@ namespace mc_rtc
       config.add("half_width", contact.halfWidth);
       config.add("pose", contact.pose);
       config.add("ref_vel", contact.refVel);
-      config.add("surface", contact.surfaceName);
+      config.add("surface", std::string(contact.surfaceName()));
       if (contact.pauseAfterSwing)
       {
         config.add("pause_after_swing", true);
       }
-      if (!contact.swingConfig.empty())
+      mc_rtc::Configuration swing = mc_rtc::ConfigurationLoader<capture_walking::SwingParams>::save(contact.swing);
+      if (!swing.empty())
       {
-        config("swing") = contact.swingConfig;
+        config("swing") = swing;
       }
       return config;
     }
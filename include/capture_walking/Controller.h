@@ -27,6 +27,8 @@
 
 #pragma once
 
+#include <array>
+#include <map>
 #include <mutex>
 #include <thread>
 
@@ -44,27 +46,37 @@
 #include <capture_walking/Contact.h>
 #include <capture_walking/FloatingBaseObserver.h>
 #include <capture_walking/FootstepPlan.h>
+#include <capture_walking/FootstepStream.h>
 #include <capture_walking/HorizontalMPCProblem.h>
 #include <capture_walking/Pendulum.h>
 #include <capture_walking/PendulumObserver.h>
+#include <capture_walking/PlanLibrary.h>
+#include <capture_walking/PlanValidator.h>
 #include <capture_walking/Preview.h>
+#include <capture_walking/PreviewPresolver.h>
+#include <capture_walking/PreviewUpdateTrigger.h>
+#include <capture_walking/SensorFrame.h>
 #include <capture_walking/Sole.h>
 #include <capture_walking/Stabilizer.h>
+#include <capture_walking/StoppingPreview.h>
+#include <capture_walking/SwingFoot.h>
+#include <capture_walking/TelemetryRecord.h>
+#include <capture_walking/VisualizationSnapshot.h>
 #include <capture_walking/defs.h>
+#include <capture_walking/utils/AllocationAudit.h>
+#include <capture_walking/utils/ChangeLog.h>
+#include <capture_walking/utils/CycleBudget.h>
+#include <capture_walking/utils/GroupedLogger.h>
 #include <capture_walking/utils/LowPassVelocityFilter.h>
+#include <capture_walking/utils/SharedMemoryRing.h>
+#include <capture_walking/utils/ThreadPolicy.h>
+#include <capture_walking/utils/TripleBuffer.h>
 #include <capture_walking/utils/clamp.h>
 #include <capture_walking/utils/rotations.h>
 
 namespace capture_walking
 {
-  /** Walking pattern generation methods.
-   *
-   */
-  enum class WalkingPatternGeneration
-  {
-    CaptureProblem,
-    HorizontalMPC
-  };
+  struct State;
 
   /** Capturability-based walking controller.
    *
@@ -118,10 +130,13 @@ namespace capture_walking
      */
     void loadFootstepPlan(std::string name);
 
-    /** Net contact wrench as measured by foot force sensors.
+    /** Sensor readings of the current control cycle.
      *
      */
-    sva::ForceVecd measuredContactWrench();
+    const SensorFrame & sensorFrame() const
+    {
+      return sensorFrame_;
+    }
 
     /** This getter is only used for consistency with the rest of mc_rtc.
      *
@@ -163,6 +178,49 @@ namespace capture_walking
       return stabilizer_;
     }
 
+    /** Install closed-form stopping preview after a solver failure.
+     *
+     * The fallback keeps a valid reference until the next successful solve.
+     * It replaces the current preview even after a single transient failure,
+     * in which case the robot starts stopping on its support contact.
+     *
+     */
+    void installFallbackPreview();
+
+    /** Check whether the walking preview should be updated.
+     *
+     * \param timeSinceLastUpdate Time since last successful update.
+     *
+     * The trigger reason is logged as "preview_trigger".
+     *
+     */
+    bool previewUpdateRequired(double timeSinceLastUpdate);
+
+    /** Request speculative pre-solve of the next double-support preview.
+     *
+     * \param remTime Remaining time in the current single-support phase.
+     *
+     * \returns True if the request was accepted by the presolver.
+     *
+     */
+    bool requestPresolve(double remTime);
+
+    /** Install pre-solved preview at the beginning of a double-support phase.
+     *
+     * \param doubleSupportDuration Duration of the new double-support phase.
+     *
+     * \param stop Whether the robot stops at the end of this phase.
+     *
+     * \returns True if a valid pre-solved preview, or a nominal one from plan
+     * validation, was installed.
+     *
+     * \note On success, inputs of cps and hmpc are refreshed to the problem
+     * that was played, but their solutions (e.g. cps_solution_step_time in
+     * logs) still describe the last online solve.
+     *
+     */
+    bool installPresolvedPreview(double doubleSupportDuration, bool stop);
+
     /** Update capturability preview.
      *
      */
@@ -191,13 +249,9 @@ namespace capture_walking
     /** Estimate left foot pressure ratio from force sensors.
      *
      */
-    inline double measuredLeftFootRatio()
+    inline double measuredLeftFootRatio() const
     {
-      double leftFootPressure = realRobot().forceSensor("LeftFootForceSensor").force().z();
-      double rightFootPressure = realRobot().forceSensor("RightFootForceSensor").force().z();
-      leftFootPressure = std::max(0., leftFootPressure);
-      rightFootPressure = std::max(0., rightFootPressure);
-      return leftFootPressure / (leftFootPressure + rightFootPressure);
+      return sensorFrame_.leftFootRatio();
     }
 
     /** Get next double support duration.
@@ -236,6 +290,19 @@ namespace capture_walking
       doubleSupportDurationOverride_ = duration;
     }
 
+    /** Get duration of next double support phase, leaving any override set
+     * by nextDoubleSupportDuration(double) in place.
+     *
+     */
+    inline double nextDoubleSupportDuration()
+    {
+      if (doubleSupportDurationOverride_ > 0.)
+      {
+        return doubleSupportDurationOverride_;
+      }
+      return plan.doubleSupportDuration();
+    }
+
     /** Get previous contact in plan.
      *
      */
@@ -284,6 +351,27 @@ namespace capture_walking
       return (supportContact().id > targetContact().id);
     }
 
+    /** True if a pause is requested after the current single support phase,
+     * either from the GUI or by the footstep plan.
+     *
+     * \note Evaluated in double support before advancing to the next
+     * footstep, as prevContact() then refers to the same contact.
+     *
+     */
+    inline bool isPauseRequested()
+    {
+      return (pauseWalking || prevContact().pauseAfterSwing);
+    }
+
+    /** True if the robot stops during the double support phase that follows
+     * the current single support phase.
+     *
+     */
+    inline bool stopAfterSwing()
+    {
+      return (isPauseRequested() || isLastSSP());
+    }
+
     /** List available contact plans.
      *
      */
@@ -296,6 +384,10 @@ namespace capture_walking
      *
      * \param label Segment label.
      *
+     * Segments are logged in three constant columns: "segment_id" (zero
+     * outside of segments), "segment_label" (index in the label dictionary)
+     * and "segment_time" (time since segment start).
+     *
      */
     void startLogSegment(const std::string & label);
 
@@ -304,53 +396,273 @@ namespace capture_walking
      */
     void stopLogSegment();
 
+    /** Get active FSM state, or nullptr between a teardown and the next
+     * start.
+     *
+     */
+    inline State * activeState()
+    {
+      return activeState_;
+    }
+
+    /** Set active FSM state.
+     *
+     * \param state State that just started, or nullptr after its teardown.
+     *
+     */
+    void activeState(State * state);
+
+    /** Add stabilizer tasks to the QP solver, if they are not there already.
+     *
+     */
+    void addStabilizerTasks();
+
+    /** Check whether a state starts for the first time, and remember it.
+     *
+     * \param name State name.
+     *
+     */
+    bool isFirstStart(const std::string & name);
+
+    /** Remove stabilizer tasks from the QP solver, if they are there.
+     *
+     */
+    void removeStabilizerTasks();
+
+    /** Get current walking phase.
+     *
+     */
+    inline WalkingPhase walkingPhase() const
+    {
+      return walkingPhase_;
+    }
+
+    /** Check whether solvers are being warmed up.
+     *
+     */
+    inline bool isWarmingUp() const
+    {
+      return isWarmingUp_;
+    }
+
+    /** Run one dummy solve of the warm-up, if it is in progress.
+     *
+     * Solves alternate between the capture problem and horizontal MPC of the
+     * upcoming step, one per cycle, so that warming up does not overrun the
+     * control cycle. The live stabilizer is left untouched.
+     *
+     */
+    void runWarmUp();
+
+    /** Start warming up solvers before the first step.
+     *
+     * Prefaults the stack of the control thread, then runWarmUp() performs
+     * the dummy solves over the next cycles. Called from the Initial state
+     * once the robot is weighed. Process memory is locked beforehand when the
+     * warm-up is configured.
+     *
+     */
+    void startWarmUp();
+
   public: /* visible to FSM states */
+    AllocationAudit allocationAudit;
     CaptureProblem cps;
+    CycleBudget cycleBudget;
     FootstepPlan plan;
     HorizontalMPCProblem hmpc;
     Sole sole;
     WalkingPatternGeneration wpg = WalkingPatternGeneration::CaptureProblem;
     bool emergencyStop = false;
     bool pauseWalking = false;
+    bool waitForFootsteps = false;
+    PreviewPresolver presolver;
     double previewUpdatePeriod = HorizontalMPC::SAMPLING_PERIOD;
     std::shared_ptr<Preview> preview;
     std::vector<std::vector<double>> halfSitPose;
+    SwingFoot swingFoot;
+
+  private: /* hidden from FSM states */
+    /** Fill preview update inputs for a double-support phase.
+     *
+     * \param initContact Contact left during the phase.
+     *
+     * \param targetContact Contact stepped on during the phase.
+     *
+     * \param nextContact Contact after target one.
+     *
+     * \param doubleSupportDuration Duration of the phase.
+     *
+     * \param stop Whether the robot stops at the end of the phase.
+     *
+     */
+    PresolveRequest makePresolveRequest(const Contact & initContact, const Contact & targetContact, const Contact & nextContact, double doubleSupportDuration, bool stop);
+
+    /** Get nominal preview cached by plan validation.
+     *
+     * \param actual Actual problem inputs at the phase transition.
+     *
+     * \returns Preview sampled from the actual initial state, or nullptr if
+     * the nominal inputs of the step do not match actual ones.
+     *
+     */
+    std::shared_ptr<Preview> takeNominalPreview(const PresolveRequest & actual);
+
+    /** Set inputs of the online preview problems from a played request.
+     *
+     * \param request Inputs of the installed preview.
+     *
+     */
+    void setPreviewInputs(const PresolveRequest & request);
+
+    /** Contact that bounds the support area along with the support contact.
+     *
+     */
+    const Contact & secondSupportContact();
+
+    /** Write dictionary of segment labels.
+     *
+     */
+    void writeSegmentLabels();
+
+    /** Configure audit of heap allocations in the control loop.
+     *
+     * \param config Configuration dictionary.
+     *
+     */
+    void configureAllocationAudit(const mc_rtc::Configuration & config);
+
+    /** Open change log of rarely-changing parameters.
+     *
+     * \param config Configuration dictionary.
+     *
+     */
+    void configureChangeLog(const mc_rtc::Configuration & config);
+
+    /** Open socket receiving footsteps of streaming plans.
+     *
+     * \param config Configuration dictionary.
+     *
+     */
+    void configureFootstepStream(const mc_rtc::Configuration & config);
+
+    /** Map library of precompiled footstep plans.
+     *
+     * \param config Configuration dictionary.
+     *
+     */
+    void configurePlanLibrary(const mc_rtc::Configuration & config);
+
+    /** Configure feasibility pre-check of footstep plans at load time.
+     *
+     * \param config Configuration dictionary.
+     *
+     */
+    void configurePlanValidation(const mc_rtc::Configuration & config);
+
+    /** Open shared-memory telemetry segment.
+     *
+     * \param config Configuration dictionary.
+     *
+     */
+    void configureTelemetry(const mc_rtc::Configuration & config);
+
+    /** Configure CPU affinity and scheduling of auxiliary threads.
+     *
+     * \param config Configuration dictionary.
+     *
+     */
+    void configureThreads(const mc_rtc::Configuration & config);
+
+    /** Configure warm-up of solvers and memory before the first step.
+     *
+     * \param config Configuration dictionary.
+     *
+     */
+    void configureWarmUp(const mc_rtc::Configuration & config);
+
+    /** Append current cycle to the shared-memory telemetry ring.
+     *
+     */
+    void writeTelemetry();
 
   private: /* hidden from FSM states */
+    ChangeLog changeLog_;
     Eigen::Vector3d controlCom_;
     Eigen::Vector3d controlComd_;
     Eigen::Vector3d realCom_;
     Eigen::Vector3d realComd_;
+    FootstepStream footstepStream_;
+    GroupedLogger logGroups_;
     LowPassVelocityFilter<Eigen::Vector3d> comVelFilter_;
     Pendulum pendulum_;
     PendulumObserver pendulumObserver_;
+    PlanLibrary planLibrary_;
+    PlanValidator planValidator_;
+    PreviewUpdateReason lastPreviewTrigger_ = PreviewUpdateReason::None;
+    PreviewUpdateTrigger previewTrigger_;
+    SensorFrame sensorFrame_;
+    SharedMemoryRing<TelemetryRecord> telemetry_;
     Stabilizer stabilizer_;
+    ThreadPolicy spinnerPolicy_;
+    State * activeState_ = nullptr;
+    WalkingPhase walkingPhase_ = WalkingPhase::Initial;
+    std::array<double, 2> firstWarmUpTimes_ = {}; // [ms] CPS, HMPC
+    std::array<double, 2> lastWarmUpTimes_ = {}; // [ms] CPS, HMPC
+    bool hasStabilizerTasks_ = false;
     bool isInTheAir_ = false;
+    bool isMemoryLocked_ = false;
+    bool isWarmingUp_ = false;
     bool leftFootRatioJumped_ = false;
+    bool lockMemory_ = true;
+    bool warmUpEnabled_ = true;
     double ctlTime_ = 0.;
     double doubleSupportDurationOverride_ = -1.; // [s]
     double leftFootRatio_ = 0.5;
     double robotMass_ = 0.; // [kg]
+    double segmentStartTime_ = 0.; // [s]
+    int segmentLabel_ = -1;
+    uint64_t soleHash_ = 0;
     FloatingBaseObserver floatingBaseObserver_;
     mc_rtc::Configuration hmpcConfig_;
     mc_rtc::Configuration plans_;
-    std::string segmentName_ = "";
+    std::map<std::string, uint64_t> planHashes_; // configurationHash() of each plan section
+    std::string logTimestamp_ = "";
+    std::string segmentLabelsPath_ = "";
+    std::string warmUpReport_ = "not run";
+    std::vector<std::string> segmentLabels_;
+    std::vector<std::string> startedStates_;
     unsigned nbCPSFailures_ = 0;
     unsigned nbCPSUpdates_ = 0;
+    unsigned nbFallbackPreviews_ = 0;
     unsigned nbHMPCFailures_ = 0;
     unsigned nbHMPCUpdates_ = 0;
-    unsigned nbLogSegments_ = 100;
+    unsigned nbLogSegments_ = 0;
+    unsigned nbNominalPreviews_ = 0;
+    unsigned nbPresolvedPreviews_ = 0;
+    unsigned nbWarmUpSolves_ = 3;
+    unsigned segmentId_ = 0;
+    unsigned stackPrefaultSize_ = 512 * 1024; // [bytes]
+    unsigned warmUpIndex_ = 0;
 
   private: /* ROS */
     visualization_msgs::Marker getArrowMarker(const std::string & frame_id, const Eigen::Vector3d & from, const Eigen::Vector3d & to, char color, double scale = 1.);
-    visualization_msgs::Marker getCoPMarker(const std::string & surfaceName, char color);
-    visualization_msgs::Marker getForceMarker(const std::string & surfaceName, char color);
-    visualization_msgs::Marker getPointMarker(const std::string & frame_id, const Eigen::Vector2d & pos, char color, double scale = 1.);
+    visualization_msgs::Marker getContactMarker(const std::string & frame_id, const FootstepWindow & window, char color);
+    visualization_msgs::Marker getForceMarker(const std::string & frame_id, const VisualizationSnapshot::Foot & foot, char color);
     visualization_msgs::Marker getPointMarker(const std::string & frame_id, const Eigen::Vector3d & pos, char color, double scale = 1.);
-    visualization_msgs::Marker getContactMarker(const std::string & frame_id, char color);
-    visualization_msgs::MarkerArray getPendulumMarkerArray(const Pendulum & state, char color);
-    void publishMarkers();
-    void publishTransforms();
+    visualization_msgs::MarkerArray getFootstepMarkerArray(const FootstepWindow & window);
+    visualization_msgs::MarkerArray getPendulumMarkerArray(const VisualizationSnapshot::Pendulum & state, char color);
+    void publishFootstepTransforms(const FootstepWindow & window);
+    void publishMarkers(const VisualizationSnapshot & snapshot);
+    void publishTransforms(const VisualizationSnapshot & snapshot);
+
+    /** Copy state needed by the ROS spinner to a new visualization snapshot,
+     * and to a new footstep window if the plan changed.
+     *
+     * \note Called from the control thread at the end of each cycle.
+     *
+     */
+    void publishSnapshot();
+
     void spinner();
 
   private: /* ROS */
@@ -361,8 +673,11 @@ namespace capture_walking
     ros::Publisher pendulumObserverPublisher_;
     ros::Publisher pendulumPublisher_;
     ros::Publisher sensorPublisher_;
+    TripleBuffer<FootstepWindow> footstepWindow_;
+    TripleBuffer<VisualizationSnapshot> snapshot_;
     std::thread spinThread_;
     std::unique_ptr<tf2_ros::TransformBroadcaster> tfBroadcaster_;
+    unsigned footstepWindowVersion_ = 0;
     unsigned rosSeq_ = 0;
   };
 }
@@ -30,6 +30,8 @@
 #include <SpaceVecAlg/SpaceVecAlg>
 #include <mc_rbdyn/Robot.h>
 
+#include <capture_walking/SensorFrame.h>
+
 namespace capture_walking
 {
   /** Kinematics-only floating-base observer.
@@ -55,8 +57,10 @@ namespace capture_walking
      *
      * \param realRobot Measured robot state, to be updated.
      *
+     * \param sensors Sensor readings of the current cycle.
+     *
      */
-    void run(const mc_rbdyn::Robot & realRobot);
+    void run(const mc_rbdyn::Robot & realRobot, const SensorFrame & sensors);
 
     /** Write observed floating-base transform to the robot's configuration.
      *
@@ -67,10 +71,10 @@ namespace capture_walking
 
     /** Update floating-base orientation based on new observed gravity vector.
      *
-     * \param realRobot Measured robot state.
+     * \param sensors Sensor readings with IMU orientation.
      *
      */
-    void estimateOrientation(const mc_rbdyn::Robot & realRobot);
+    void estimateOrientation(const SensorFrame & sensors);
 
     /* Update floating-base position.
      *
@@ -28,15 +28,33 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include <capture_walking/Contact.h>
 #include <capture_walking/HorizontalMPC.h>
+#include <capture_walking/PlanRecord.h>
 #include <capture_walking/Sole.h>
 #include <capture_walking/utils/clamp.h>
 
 namespace capture_walking
 {
+  /** Maximum number of contacts held by a streaming plan.
+   *
+   */
+  constexpr unsigned STREAMING_PLAN_CAPACITY = 64;
+
+  /** Number of passed contacts kept by a streaming plan.
+   *
+   */
+  constexpr unsigned STREAMING_PLAN_KEEP_BEHIND = 2;
+
   /** Sequence of footsteps with gait parameters.
+   *
+   * Contact indices are absolute. A streaming plan starts from the contacts
+   * of its configuration, receives upcoming contacts with appendContact()
+   * and drops passed ones, so that its memory use is bounded over unbounded
+   * walks. If no new contact is received, the robot stops as at the end of
+   * a regular plan, and resumes walking once new contacts are appended.
    *
    */
   struct FootstepPlan
@@ -48,6 +66,15 @@ namespace capture_walking
      */
     void load(const mc_rtc::Configuration & config);
 
+    /** Load plan from binary plan library records, without parsing.
+     *
+     * \param record Gait parameters.
+     *
+     * \param contacts Array of the record.nbContacts contacts of the plan.
+     *
+     */
+    void load(const PlanRecord & record, const ContactRecord * contacts);
+
     /** Save plan to configuration  dictionary.
      *
      * \param config Configuration dictionary.
@@ -55,6 +82,16 @@ namespace capture_walking
      */
     void save(mc_rtc::Configuration & config) const;
 
+    /** Save plan to binary plan library records.
+     *
+     * \param record Gait parameters, HMPC weights are left unchanged.
+     *
+     * \param contacts Contact records, to which contacts of the plan are
+     * appended.
+     *
+     */
+    void save(PlanRecord & record, std::vector<ContactRecord> & contacts) const;
+
     /** Complete contacts from sole parameters.
      *
      * \param sole Sole parameters.
@@ -69,6 +106,24 @@ namespace capture_walking
      */
     void reset(unsigned startIndex = 0);
 
+    /** Append upcoming contact to a streaming plan.
+     *
+     * If the plan was starved, the new contact becomes the current target or
+     * next contact.
+     *
+     * \param contact New contact, completed from sole parameters.
+     *
+     * \returns False if the plan is full.
+     *
+     */
+    bool appendContact(const Contact & contact);
+
+    /** Copy contacts appended to a streaming plan that have not been walked
+     * yet, so that they survive a reload of the plan.
+     *
+     */
+    std::vector<Contact> streamedContacts() const;
+
     /** Advance to next footstep in plan.
      *
      */
@@ -114,11 +169,31 @@ namespace capture_walking
       comHeight_ = clamp(height, MIN_COM_HEIGHT, MAX_COM_HEIGHT);
     }
 
-    /** Reference to list of contacts.
+    /** Pose of a contact in plan, including measured drift.
+     *
+     * \param i Contact index.
+     *
+     */
+    inline sva::PTransformd contactPose(unsigned i) const
+    {
+      const sva::PTransformd & pose = contacts_[i - firstIndex_].pose;
+      if (i < driftIndex_)
+      {
+        return pose;
+      }
+      return sva::PTransformd(drift_) * pose;
+    }
+
+    /** Reference to list of contacts held by the plan, starting from
+     * firstIndex().
+     *
+     * \note Pending drift is applied to all remaining contacts, which takes
+     * linear time. Use contactPose() from the control loop.
      *
      */
-    inline const std::vector<Contact> & contacts() const
+    inline const std::vector<Contact> & contacts()
     {
+      applyDrift();
       return contacts_;
     }
 
@@ -181,9 +256,9 @@ namespace capture_walking
      */
     inline double landingPitch() const
     {
-      if (prevContact_.swingConfig.has("landing_pitch"))
+      if (SwingParams::isSet(prevContact_.swing.landingPitch))
       {
-        return prevContact_.swingConfig("landing_pitch");
+        return prevContact_.swing.landingPitch;
       }
       return landingPitch_;
     }
@@ -203,9 +278,9 @@ namespace capture_walking
      */
     inline double landingRatio() const
     {
-      if (supportContact_.swingConfig.has("landing_ratio"))
+      if (SwingParams::isSet(supportContact_.swing.landingRatio))
       {
-        return supportContact_.swingConfig("landing_ratio");
+        return supportContact_.swing.landingRatio;
       }
       return landingRatio_;
     }
@@ -228,6 +303,14 @@ namespace capture_walking
       return nextContact_;
     }
 
+    /** Index of the contact after the current target one.
+     *
+     */
+    inline unsigned nextFootstep() const
+    {
+      return nextFootstep_;
+    }
+
     /** Previous contact in plan.
      *
      */
@@ -269,9 +352,9 @@ namespace capture_walking
      */
     inline double swingHeight() const
     {
-      if (prevContact_.swingConfig.has("height"))
+      if (SwingParams::isSet(prevContact_.swing.height))
       {
-        return prevContact_.swingConfig("height");
+        return prevContact_.swing.height;
       }
       return swingHeight_;
     }
@@ -291,9 +374,9 @@ namespace capture_walking
      */
     inline Eigen::Vector3d takeoffOffset() const
     {
-      if (prevContact_.swingConfig.has("takeoff_offset"))
+      if (SwingParams::isSet(prevContact_.swing.takeoffOffset.x()))
       {
-        return prevContact_.swingConfig("takeoff_offset");
+        return prevContact_.swing.takeoffOffset;
       }
       return takeoffOffset_;
     }
@@ -311,9 +394,9 @@ namespace capture_walking
      */
     inline double takeoffPitch() const
     {
-      if (prevContact_.swingConfig.has("takeoff_pitch"))
+      if (SwingParams::isSet(prevContact_.swing.takeoffPitch))
       {
-        return prevContact_.swingConfig("takeoff_pitch");
+        return prevContact_.swing.takeoffPitch;
       }
       return takeoffPitch_;
     }
@@ -341,9 +424,9 @@ namespace capture_walking
      */
     inline double takeoffRatio() const
     {
-      if (supportContact_.swingConfig.has("takeoff_ratio"))
+      if (SwingParams::isSet(supportContact_.swing.takeoffRatio))
       {
-        return supportContact_.swingConfig("takeoff_ratio");
+        return supportContact_.swing.takeoffRatio;
       }
       return takeoffRatio_;
     }
@@ -358,6 +441,76 @@ namespace capture_walking
       takeoffRatio_ = clamp(ratio, 0., 0.5);
     }
 
+    /** Index after the last contact held by the plan.
+     *
+     */
+    inline unsigned endIndex() const
+    {
+      return firstIndex_ + static_cast<unsigned>(contacts_.size());
+    }
+
+    /** Index of the first contact held by the plan.
+     *
+     */
+    inline unsigned firstIndex() const
+    {
+      return firstIndex_;
+    }
+
+    /** Check whether upcoming contacts are streamed to the plan.
+     *
+     */
+    inline bool isStreaming() const
+    {
+      return isStreaming_;
+    }
+
+    /** Counter updated whenever contacts or the current footstep change.
+     *
+     */
+    inline unsigned version() const
+    {
+      return version_;
+    }
+
+  private:
+    /** Apply pending drift to all contacts that have not been passed yet.
+     *
+     */
+    void applyDrift();
+
+    /** Copy contact from plan, including measured drift.
+     *
+     * \param i Contact index.
+     *
+     * \param contact Destination contact.
+     *
+     */
+    void copyContact(unsigned i, Contact & contact) const;
+
+    /** Drop passed contacts of a streaming plan, keeping
+     * STREAMING_PLAN_KEEP_BEHIND of them.
+     *
+     */
+    void dropPassedContacts();
+
+    /** Apply pending drift to passed contacts, which will not drift any more.
+     *
+     * \param endIndex Index after the last passed contact.
+     *
+     */
+    void freezeDrift(unsigned endIndex);
+
+    /** Get contact held by the plan from its index.
+     *
+     * \param i Contact index.
+     *
+     */
+    inline Contact & storedContact(unsigned i)
+    {
+      return contacts_[i - firstIndex_];
+    }
+
   public:
     std::string name = "";
 
@@ -366,6 +519,7 @@ namespace capture_walking
     Contact prevContact_;
     Contact supportContact_;
     Contact targetContact_;
+    Eigen::Vector3d drift_ = Eigen::Vector3d::Zero(); // [m]
     Eigen::Vector3d takeoffOffset_ = Eigen::Vector3d::Zero();
     double comHeight_ = 0.78; // [m]
     double doubleSupportDuration_ = 0.2; // [s]
@@ -377,8 +531,13 @@ namespace capture_walking
     double swingHeight_ = 0.04; // [m]
     double takeoffPitch_ = 0.;
     double takeoffRatio_ = 0.05;
+    bool isStreaming_ = false;
     std::vector<Contact> contacts_;
+    unsigned driftIndex_ = 0;
+    unsigned firstIndex_ = 0;
+    unsigned firstStreamedIndex_ = 0;
     unsigned nextFootstep_ = 0;
+    unsigned version_ = 0;
   };
 }
 
@@ -0,0 +1,114 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <string>
+
+#include <capture_walking/Contact.h>
+#include <capture_walking/FootstepPlan.h>
+#include <capture_walking/Sole.h>
+#include <capture_walking/StreamedFootstep.h>
+
+namespace capture_walking
+{
+  /** Receiver of upcoming footsteps from an external planner.
+   *
+   * Footsteps are received as StreamedFootstep datagrams on a local UNIX
+   * socket, which is read without blocking from the control loop. Datagrams
+   * wait in the socket queue while the streaming plan is full, so that the
+   * producer is throttled when it blocks on sending.
+   *
+   */
+  struct FootstepStream
+  {
+    /** Close socket.
+     *
+     */
+    ~FootstepStream();
+
+    /** Bind socket.
+     *
+     * \param path Socket path.
+     *
+     * \returns True if the socket is ready to receive footsteps.
+     *
+     */
+    bool open(const std::string & path);
+
+    /** Close socket and remove its path.
+     *
+     */
+    void close();
+
+    /** Check whether the socket is open.
+     *
+     */
+    bool isOpen() const
+    {
+      return (fd_ >= 0);
+    }
+
+    /** Number of footsteps appended to plans so far.
+     *
+     */
+    unsigned nbReceived() const
+    {
+      return nbReceived_;
+    }
+
+    /** Append received footsteps to a streaming plan.
+     *
+     * \param plan Streaming footstep plan.
+     *
+     * \param sole Sole parameters used to complete contacts.
+     *
+     * \returns Number of contacts appended to the plan.
+     *
+     */
+    unsigned receive(FootstepPlan & plan, const Sole & sole);
+
+  private:
+    /** Convert datagram to contact.
+     *
+     * \param footstep Received footstep.
+     *
+     * \param sole Sole parameters used to complete contacts.
+     *
+     * \returns False if the footstep is invalid.
+     *
+     */
+    bool toContact(const StreamedFootstep & footstep, const Sole & sole);
+
+  private:
+    Contact pending_;
+    bool hasPending_ = false;
+    int fd_ = -1;
+    std::string path_ = "";
+    unsigned nbReceived_ = 0;
+  };
+}
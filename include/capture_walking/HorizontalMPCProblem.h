@@ -37,11 +37,6 @@
 #include <capture_walking/HorizontalMPCSolution.h>
 #include <capture_walking/defs.h>
 
-namespace Eigen
-{
-  using HrepXd = std::pair<Eigen::MatrixXd, Eigen::VectorXd>;
-}
-
 namespace capture_walking
 {
   /** Model Predictive Control problem for horizontal walking.
@@ -64,13 +59,18 @@ namespace capture_walking
     void configure(const mc_rtc::Configuration &);
 
     /** Reset contacts.
+     *
+     * Contacts should come from a completed footstep plan, so that their
+     * ZMP halfspaces and ankle positions are precomputed.
      *
      * \param initContact Contact used during single-support phase.
      *
      * \param targetContact Contact used during double-support phases.
      *
+     * \param nextContact Contact used after the target one.
+     *
      */
-    void contacts(Contact initContact, Contact targetContact, Contact nextContact)
+    void contacts(const Contact & initContact, const Contact & targetContact, const Contact & nextContact)
     {
       initContact_ = initContact;
       nextContact_ = nextContact;
@@ -84,7 +84,6 @@ namespace capture_walking
      */
     void initState(const Pendulum & state)
     {
-      initState_ = Eigen::VectorXd(6);
       initState_ << 
         state.com().head<2>(), 
         state.comd().head<2>(),
@@ -151,8 +150,6 @@ namespace capture_walking
     void writePython(const std::string & suffix = "");
 
   private:
-    Eigen::HrepXd getSingleSupportHrep(const Contact & contact);
-
     void computeZMPRef();
 
     void updateTerminalConstraint();
@@ -180,7 +177,6 @@ namespace capture_walking
     Contact initContact_;
     Contact nextContact_;
     Contact targetContact_;
-    Eigen::HrepXd hreps_[4];
     Eigen::Matrix<double, 2 * (HorizontalMPC::NB_STEPS + 1), 1> velRef_;
     Eigen::Matrix<double, 2 * (HorizontalMPC::NB_STEPS + 1), 1> zmpRef_;
     Eigen::Matrix<double, 2, HorizontalMPC::STATE_SIZE> dcmFromState_;
@@ -99,6 +99,24 @@ namespace capture_walking
      */
     void integratePostPlayback(Pendulum & state, double dt);
 
+    /** Sample the reference over the solution horizon.
+     *
+     * \param state Initial CoM state.
+     *
+     * \param dt Sampling period, normally the controller timestep.
+     *
+     * \param plane Contact plane of the states playing the solution, used to
+     * reset CoM height then complete ZMP and omega of samples.
+     *
+     * \param comHeight CoM height above the contact plane.
+     *
+     * Fills the lookahead buffer so that subsequent calls to integrate() with
+     * the same timestep become table lookups. Samples are processed as by the
+     * states during playback, so that lookahead() predicts played states.
+     *
+     */
+    void sample(const Pendulum & state, double dt, const Contact & plane, double comHeight);
+
     /** Get the CoM state trajectory.
      *
      */
@@ -115,6 +133,16 @@ namespace capture_walking
       return jerkTraj_;
     }
 
+  private:
+    /** Integrate one step of the jerk trajectory.
+     *
+     * \param state CoM state to integrate upon.
+     *
+     * \param dt Duration.
+     *
+     */
+    void integrateSolution(Pendulum & state, double dt);
+
   private:
     Eigen::VectorXd jerkTraj_;
     Eigen::VectorXd stateTraj_;
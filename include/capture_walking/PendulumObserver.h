@@ -31,6 +31,7 @@
 
 #include <capture_walking/Pendulum.h>
 #include <capture_walking/Contact.h>
+#include <capture_walking/SensorFrame.h>
 #include <capture_walking/defs.h>
 
 namespace capture_walking
@@ -51,13 +52,13 @@ namespace capture_walking
      *
      * \param comGuess Guess for the CoM position.
      *
-     * \param contactWrench Net contact wrench expressed at the origin of the
-     * inertial frame.
+     * \param sensors Sensor readings with net contact wrench expressed at the
+     * origin of the inertial frame.
      *
      * \param contact Support contact.
      *
      */
-    void update(const Eigen::Vector3d & mb_com, const sva::ForceVecd & contactWrench, const Contact & contact);
+    void update(const Eigen::Vector3d & mb_com, const SensorFrame & sensors, const Contact & contact);
 
     /** Get contact force.
      *
@@ -0,0 +1,133 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <string>
+
+#include <capture_walking/FootstepPlan.h>
+#include <capture_walking/PlanRecord.h>
+
+namespace capture_walking
+{
+  /** Memory-mapped library of precompiled footstep plans.
+   *
+   * Libraries are written by the plan_compiler tool from the "plans" section
+   * of the controller configuration. Plans are instantiated by copying their
+   * records, without parsing configuration files at startup or at plan
+   * switches. Plans whose configuration changed since they were compiled are
+   * detected from their hashes and read from the configuration instead.
+   *
+   */
+  struct PlanLibrary
+  {
+    /** Unmap library.
+     *
+     */
+    ~PlanLibrary();
+
+    /** Map library file and check its layout.
+     *
+     * \param path Path to library file.
+     *
+     * \returns True if the library is ready to use.
+     *
+     */
+    bool open(const std::string & path);
+
+    /** Unmap library.
+     *
+     */
+    void close();
+
+    /** Find plan by name.
+     *
+     * \param name Plan name.
+     *
+     * \returns Plan index, or -1 if the plan is not in the library.
+     *
+     */
+    int find(const std::string & name) const;
+
+    /** Check whether a precompiled plan was compiled from the current
+     * configuration.
+     *
+     * \param index Plan index.
+     *
+     * \param planHash Hash of the plan configuration, see configurationHash().
+     *
+     * \param soleHash Hash of the sole configuration.
+     *
+     */
+    bool isUpToDate(unsigned index, uint64_t planHash, uint64_t soleHash) const
+    {
+      return (plans_[index].planHash == planHash && plans_[index].soleHash == soleHash);
+    }
+
+    /** Instantiate plan from its records.
+     *
+     * \param index Plan index.
+     *
+     * \param plan Footstep plan to load.
+     *
+     */
+    void instantiate(unsigned index, FootstepPlan & plan) const;
+
+    /** Check whether a library is mapped.
+     *
+     */
+    bool isOpen() const
+    {
+      return (data_ != nullptr);
+    }
+
+    /** Number of plans in library.
+     *
+     */
+    unsigned nbPlans() const
+    {
+      return isOpen() ? header_->nbPlans : 0;
+    }
+
+    /** Get plan record.
+     *
+     * \param index Plan index.
+     *
+     */
+    const PlanRecord & plan(unsigned index) const
+    {
+      return plans_[index];
+    }
+
+  private:
+    const ContactRecord * contacts_ = nullptr;
+    const PlanLibraryHeader * header_ = nullptr;
+    const PlanRecord * plans_ = nullptr;
+    size_t size_ = 0;
+    void * data_ = nullptr;
+  };
+}
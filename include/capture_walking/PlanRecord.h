@@ -0,0 +1,136 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace capture_walking
+{
+  /** Magic number identifying binary plan libraries.
+   *
+   */
+  constexpr uint32_t PLAN_LIBRARY_MAGIC = 0x43575042; // "CWPB"
+
+  /** Version of the binary plan library layout.
+   *
+   */
+  constexpr uint32_t PLAN_LIBRARY_VERSION = 2;
+
+  /** Maximum length of a plan name, including the terminating null byte.
+   *
+   */
+  constexpr unsigned PLAN_NAME_SIZE = 64;
+
+  /** Hash of a configuration section, used to detect precompiled plans that
+   * are older than their configuration.
+   *
+   * \param json Section dumped to JSON.
+   *
+   * \returns 64-bit FNV-1a hash of the JSON string.
+   *
+   */
+  inline uint64_t configurationHash(const std::string & json)
+  {
+    uint64_t hash = 0xcbf29ce484222325;
+    for (char c : json)
+    {
+      hash ^= static_cast<unsigned char>(c);
+      hash *= 0x100000001b3;
+    }
+    return hash;
+  }
+
+  /** Header of a binary plan library.
+   *
+   * The header is followed by nbPlans PlanRecord then nbContacts
+   * ContactRecord. Records only contain fixed-size types and are 8-byte
+   * aligned, so that they can be used in place from a memory-mapped file.
+   * Optional values are NaN when unset.
+   *
+   */
+  struct PlanLibraryHeader
+  {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t nbPlans;
+    uint32_t nbContacts;
+  };
+
+  /** Gait parameters of a footstep plan.
+   *
+   */
+  struct PlanRecord
+  {
+    char name[PLAN_NAME_SIZE];
+    double comHeight; // [m]
+    double doubleSupportDuration; // [s]
+    double finalDSPDuration; // [s]
+    double initDSPDuration; // [s]
+    double landingPitch; // [rad]
+    double landingRatio;
+    double singleSupportDuration; // [s]
+    double swingHeight; // [m]
+    double takeoffOffset[3]; // [m]
+    double takeoffPitch; // [rad]
+    double takeoffRatio;
+    double hmpcJerkWeight; // optional
+    double hmpcVelWeights[2]; // optional
+    double hmpcZMPWeight; // optional
+    uint64_t planHash; // configurationHash() of the plan section
+    uint64_t soleHash; // configurationHash() of the sole section
+    uint32_t firstContact;
+    uint32_t nbContacts;
+    uint32_t isStreaming;
+    uint32_t reserved;
+  };
+
+  /** Contact of a footstep plan, completed from sole parameters.
+   *
+   */
+  struct ContactRecord
+  {
+    double rotation[9]; // row-major
+    double translation[3]; // [m]
+    double refVel[3]; // [m] / [s]
+    double halfLength; // [m]
+    double halfWidth; // [m]
+    double swingHeight; // optional
+    double swingLandingPitch; // optional
+    double swingLandingRatio; // optional
+    double swingTakeoffOffset[3]; // optional
+    double swingTakeoffPitch; // optional
+    double swingTakeoffRatio; // optional
+    uint32_t surface; // ContactSurface value
+    uint32_t pauseAfterSwing;
+  };
+
+  static_assert(sizeof(PlanLibraryHeader) % 8 == 0, "plan library records must stay 8-byte aligned");
+  static_assert(sizeof(PlanRecord) % 8 == 0, "plan library records must stay 8-byte aligned");
+  static_assert(sizeof(ContactRecord) % 8 == 0, "plan library records must stay 8-byte aligned");
+}
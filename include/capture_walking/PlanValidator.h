@@ -0,0 +1,192 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <mc_rtc/Configuration.h>
+
+#include <capture_walking/CaptureProblem.h>
+#include <capture_walking/FootstepPlan.h>
+#include <capture_walking/HorizontalMPCProblem.h>
+#include <capture_walking/PreviewPresolver.h>
+#include <capture_walking/utils/Interval.h>
+#include <capture_walking/utils/ThreadPolicy.h>
+
+namespace capture_walking
+{
+  /** Outcome of the nominal problems of a step transition.
+   *
+   */
+  struct StepValidation
+  {
+    PresolveRequest nominal; // wpg is unused
+    std::shared_ptr<CaptureSolution> cpsSolution; // nullptr if infeasible
+    std::shared_ptr<HorizontalMPCSolution> hmpcSolution; // nullptr if infeasible
+    std::vector<Interval> alphaIntervals;
+    cps::SolverStatus cpsStatus = cps::SolverStatus::Fail;
+    double stepTimeError = std::numeric_limits<double>::quiet_NaN(); // [s]
+  };
+
+  /** Feasibility pre-check of all step transitions of a footstep plan.
+   *
+   * When a plan is loaded, the nominal double-support preview of every step
+   * is solved with both the capture problem and the horizontal MPC, on
+   * background threads spread over available cores. Results are reported to
+   * the log once all steps are validated, and nominal solutions are kept as
+   * warm starts for previews whose actual inputs match nominal ones.
+   *
+   */
+  struct PlanValidator
+  {
+    /** Stop background threads.
+     *
+     */
+    ~PlanValidator();
+
+    /** Read configuration from dictionary.
+     *
+     * \param config Configuration dictionary.
+     *
+     */
+    void configure(const mc_rtc::Configuration & config);
+
+    /** Cancel validation in progress, if any, and wait for its threads.
+     *
+     */
+    void cancel();
+
+    /** Start validation of a footstep plan.
+     *
+     * \param plan Footstep plan.
+     *
+     * \param defaults Solver parameters, contacts and durations are ignored.
+     *
+     * Returns immediately, validation runs on background threads.
+     *
+     */
+    void start(FootstepPlan & plan, const PresolveRequest & defaults);
+
+    /** Set CPU affinity and scheduling of worker threads.
+     *
+     * \param policy Thread policy, applied to workers of the next validation.
+     *
+     */
+    void threadPolicy(const ThreadPolicy & policy)
+    {
+      threadPolicy_ = policy;
+    }
+
+    /** Get nominal results of the step to a given contact.
+     *
+     * \param targetId Index of the contact the step lands on.
+     *
+     * \returns Validation results, or nullptr if validation is not complete
+     * or the step is not part of the validated plan.
+     *
+     */
+    const StepValidation * step(unsigned targetId) const;
+
+    /** True if plan validation is enabled.
+     *
+     */
+    bool enabled() const
+    {
+      return enabled_;
+    }
+
+    /** True if all steps of the last plan are validated.
+     *
+     */
+    bool isDone() const
+    {
+      return isDone_.load(std::memory_order_acquire);
+    }
+
+    /** Number of steps with an infeasible nominal problem, or zero while
+     * validation is in progress.
+     *
+     */
+    unsigned nbInfeasibleSteps() const
+    {
+      return isDone() ? nbInfeasibleSteps_ : 0;
+    }
+
+    /** Number of validated steps.
+     *
+     */
+    unsigned nbSteps() const
+    {
+      return static_cast<unsigned>(steps_.size());
+    }
+
+  private:
+    /** Report results of a finished validation.
+     *
+     */
+    void report();
+
+    /** Solve nominal problems of a step.
+     *
+     * \param cps Capture problem owned by the calling thread.
+     *
+     * \param hmpc Horizontal MPC problem owned by the calling thread.
+     *
+     * \param step Step to validate.
+     *
+     */
+    static void validate(CaptureProblem & cps, HorizontalMPCProblem & hmpc, StepValidation & step);
+
+    /** Main loop of a worker thread.
+     *
+     */
+    void workerLoop();
+
+  private:
+    ThreadPolicy threadPolicy_;
+    bool enabled_ = false;
+    bool verbose_ = false;
+    std::atomic<bool> isDone_{false};
+    std::atomic<bool> stop_{false};
+    std::atomic<unsigned> nbValidated_{0};
+    std::atomic<unsigned> nextStep_{0};
+    std::chrono::steady_clock::time_point startTime_;
+    std::string planName_ = "";
+    std::vector<StepValidation> steps_;
+    std::vector<std::thread> workers_;
+    unsigned firstTargetId_ = 0;
+    unsigned nbInfeasibleSteps_ = 0;
+    unsigned nbThreads_ = 0; // zero for all cores
+  };
+}
@@ -29,9 +29,23 @@
 
 #include <capture_walking/Pendulum.h>
 #include <capture_walking/defs.h>
+#include <capture_walking/utils/RingBuffer.h>
 
 namespace capture_walking
 {
+  constexpr unsigned PREVIEW_BUFFER_SIZE = 400; // 2 [s] at 200 [Hz]
+
+  /** Reference state sampled from a preview.
+   *
+   */
+  struct PreviewSample
+  {
+    Pendulum state;
+    bool playbackIsOver = false;
+    double playbackTime = 0.;
+    unsigned playbackStep = 0;
+  };
+
   /** Solution to a model predictive control problem.
    *
    */
@@ -46,6 +60,35 @@ namespace capture_walking
      */
     virtual void integrate(Pendulum & state, double dt) = 0;
 
+    /** Get sampled reference a given number of control steps ahead.
+     *
+     * \param n Number of steps ahead, zero being the state after the next call
+     * to integrate().
+     *
+     * \note Indexes past the sampled horizon return the last sample, or the
+     * last played one when the buffer is empty. Check nbSamples() first.
+     * Samples are the states the walking states will play, including any
+     * contact-plane completion they apply.
+     *
+     */
+    const Pendulum & lookahead(unsigned n) const
+    {
+      if (samples_.empty())
+      {
+        return lastSample_;
+      }
+      unsigned i = (n < samples_.size()) ? n : samples_.size() - 1;
+      return samples_[i].state;
+    }
+
+    /** Number of samples remaining in the lookahead buffer.
+     *
+     */
+    unsigned nbSamples() const
+    {
+      return samples_.size();
+    }
+
     /** Get current playback step.
      *
      */
@@ -63,7 +106,66 @@ namespace capture_walking
     }
 
   protected:
+    /** Clear lookahead buffer before sampling a new horizon.
+     *
+     * \param dt Sampling period.
+     *
+     */
+    void clearSamples(double dt)
+    {
+      sampleDt_ = dt;
+      samples_.clear();
+    }
+
+    /** Append current playback state to the lookahead buffer.
+     *
+     * \param state Reference state after integration.
+     *
+     */
+    void pushSample(const Pendulum & state)
+    {
+      PreviewSample sample;
+      sample.state = state;
+      sample.playbackIsOver = playbackIsOver_;
+      sample.playbackTime = playbackTime_;
+      sample.playbackStep = playbackStep_;
+      samples_.push_back(sample);
+    }
+
+    /** Play next sample from the lookahead buffer, if available.
+     *
+     * \param state Reference state to update.
+     *
+     * \param dt Integration step.
+     *
+     * \returns True if the state was updated from the buffer.
+     *
+     */
+    bool playSample(Pendulum & state, double dt)
+    {
+      if (samples_.empty() || std::abs(dt - sampleDt_) > 1e-10)
+      {
+        return false;
+      }
+      const PreviewSample & sample = samples_.front();
+      state = sample.state;
+      if (samples_.size() == 1)
+      {
+        lastSample_ = sample.state;
+      }
+      playbackIsOver_ = sample.playbackIsOver;
+      playbackTime_ = sample.playbackTime;
+      playbackStep_ = sample.playbackStep;
+      samples_.pop_front();
+      return true;
+    }
+
+  protected:
+    Pendulum lastSample_;
+    RingBuffer<PreviewSample, PREVIEW_BUFFER_SIZE> samples_;
+    bool playbackIsOver_ = false;
     double playbackTime_ = 0.;
+    double sampleDt_ = 0.;
     unsigned playbackStep_ = 0;
   };
 }
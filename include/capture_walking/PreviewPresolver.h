@@ -0,0 +1,209 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <mc_rtc/Configuration.h>
+
+#include <capture_walking/CaptureProblem.h>
+#include <capture_walking/Contact.h>
+#include <capture_walking/HorizontalMPCProblem.h>
+#include <capture_walking/Pendulum.h>
+#include <capture_walking/Preview.h>
+#include <capture_walking/defs.h>
+#include <capture_walking/utils/ThreadPolicy.h>
+
+namespace capture_walking
+{
+  /** Inputs of a preview update for a double-support phase.
+   *
+   */
+  struct PresolveRequest
+  {
+    Contact initContact;
+    Contact nextContact;
+    Contact targetContact;
+    Eigen::Vector2d ankleToTargetCoP = {0., 0.};
+    Eigen::Vector2d velWeights = {0., 0.};
+    Pendulum initState;
+    WalkingPatternGeneration wpg = WalkingPatternGeneration::CaptureProblem;
+    double comHeight = 0.; // [m]
+    double doubleSupportDuration = 0.; // [s]
+    double jerkWeight = 0.;
+    double singleSupportDuration = 0.; // [s], zero when stopping after the DSP
+    double zmpWeight = 0.;
+  };
+
+  /** Speculative solver for the preview of the next double-support phase.
+   *
+   * During the end of a single-support phase, the controller requests a
+   * preview update computed from the predicted touchdown state. The problem is
+   * solved on a background thread with its own CaptureProblem and
+   * HorizontalMPCProblem instances. At the transition, the result is
+   * validated against the actual state and contacts before being installed.
+   *
+   */
+  struct PreviewPresolver
+  {
+    /** Initialize presolver (without starting its thread).
+     *
+     */
+    PreviewPresolver() = default;
+
+    /** Stop background thread.
+     *
+     */
+    ~PreviewPresolver();
+
+    /** Read configuration from dictionary, and start background thread if
+     * enabled.
+     *
+     * \param config Configuration dictionary.
+     *
+     */
+    void configure(const mc_rtc::Configuration & config);
+
+    /** Set CPU affinity and scheduling of the background thread.
+     *
+     * \param policy Thread policy, applied now if the thread is running.
+     *
+     */
+    void threadPolicy(const ThreadPolicy & policy);
+
+    /** Discard pending or available results.
+     *
+     */
+    void cancel();
+
+    /** Request a pre-solve.
+     *
+     * \param request Problem inputs.
+     *
+     * \returns True if the request was accepted.
+     *
+     * This function does not block: it returns false when the background
+     * thread is busy with another request.
+     *
+     */
+    bool request(const PresolveRequest & request);
+
+    /** Validate and take result of the last request.
+     *
+     * \param actual Actual problem inputs at the phase transition.
+     *
+     * \param dt Controller timestep used to sample the preview.
+     *
+     * \returns Preview sampled from the actual initial state, or nullptr if
+     * no valid result is available.
+     *
+     * Consumes the result whether it is valid or not. This function does not
+     * block.
+     *
+     */
+    std::shared_ptr<Preview> take(const PresolveRequest & actual, double dt);
+
+    /** Check that a result computed for some inputs applies to others.
+     *
+     * \param expected Inputs the result was computed for.
+     *
+     * \param actual Actual problem inputs.
+     *
+     */
+    bool matches(const PresolveRequest & expected, const PresolveRequest & actual) const;
+
+    /** True if pre-solving is enabled.
+     *
+     */
+    bool enabled() const
+    {
+      return enabled_;
+    }
+
+    /** Get duration before the end of single support where pre-solving is
+     * requested.
+     *
+     */
+    double window() const
+    {
+      return window_;
+    }
+
+  private:
+    /** Solve request on the background thread.
+     *
+     * \param request Problem inputs.
+     *
+     * \param cpsSolution Solution, set if request uses the capture problem.
+     *
+     * \param hmpcSolution Solution, set if request uses the horizontal MPC.
+     *
+     */
+    bool solve(const PresolveRequest & request, std::shared_ptr<CaptureSolution> & cpsSolution, std::shared_ptr<HorizontalMPCSolution> & hmpcSolution);
+
+    /** Main loop of the background thread.
+     *
+     */
+    void workerLoop();
+
+  private:
+    /** Status of the background computation.
+     *
+     */
+    enum class Status
+    {
+      Idle,
+      Pending,
+      Solving,
+      Ready
+    };
+
+  private:
+    CaptureProblem cps_;
+    HorizontalMPCProblem hmpc_;
+    PresolveRequest request_;
+    Status status_ = Status::Idle;
+    ThreadPolicy threadPolicy_;
+    bool enabled_ = false;
+    bool stop_ = false;
+    double maxComError_ = 0.01; // [m]
+    double maxComdError_ = 0.05; // [m] / [s]
+    double maxComddError_ = 0.5; // [m] / [s]^2
+    double maxContactError_ = 0.01; // [m]
+    double window_ = 0.15; // [s]
+    std::condition_variable condition_;
+    std::mutex mutex_;
+    std::shared_ptr<CaptureSolution> cpsSolution_;
+    std::shared_ptr<HorizontalMPCSolution> hmpcSolution_;
+    std::thread worker_;
+    unsigned generation_ = 0;
+  };
+}
@@ -0,0 +1,138 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <mc_rtc/Configuration.h>
+
+namespace capture_walking
+{
+  /** Reasons for updating the walking preview.
+   *
+   */
+  enum class PreviewUpdateReason
+  {
+    None = 0,
+    Period = 1,
+    DCMError = 2,
+    ZMPMargin = 3,
+    ContactDrift = 4
+  };
+
+  /** Decide when to update the walking preview.
+   *
+   * In periodic mode, the preview is updated whenever the time since the last
+   * update exceeds the update period. In event-triggered mode, the update
+   * period becomes a minimum time between updates, and updates only fire when
+   * the DCM tracking error, the ZMP margin or the contact drift cross their
+   * thresholds. A longer fallback period still applies in this mode.
+   *
+   */
+  struct PreviewUpdateTrigger
+  {
+    /** Check whether the preview should be updated.
+     *
+     * \param timeSinceLastUpdate Time since last successful update.
+     *
+     * \param period Preview update period.
+     *
+     * \param dcmError Norm of horizontal DCM tracking error.
+     *
+     * \param zmpMargin Distance from reference ZMP to the boundary of the
+     * support area, positive inside.
+     *
+     * \param contactDrift Distance between planned and measured support
+     * contacts.
+     *
+     */
+    PreviewUpdateReason check(double timeSinceLastUpdate, double period, double dcmError, double zmpMargin, double contactDrift) const
+    {
+      if (!eventTriggered)
+      {
+        return (timeSinceLastUpdate > period) ? PreviewUpdateReason::Period : PreviewUpdateReason::None;
+      }
+      if (timeSinceLastUpdate > maxPeriod)
+      {
+        return PreviewUpdateReason::Period;
+      }
+      if (timeSinceLastUpdate <= period)
+      {
+        return PreviewUpdateReason::None;
+      }
+      if (dcmError > maxDCMError)
+      {
+        return PreviewUpdateReason::DCMError;
+      }
+      if (zmpMargin < minZMPMargin)
+      {
+        return PreviewUpdateReason::ZMPMargin;
+      }
+      if (contactDrift > maxContactDrift)
+      {
+        return PreviewUpdateReason::ContactDrift;
+      }
+      return PreviewUpdateReason::None;
+    }
+
+    bool eventTriggered = false;
+    double maxContactDrift = 0.01; // [m]
+    double maxDCMError = 0.02; // [m]
+    double maxPeriod = 0.4; // [s]
+    double minZMPMargin = 0.01; // [m]
+  };
+}
+
+namespace mc_rtc
+{
+  template<>
+  struct ConfigurationLoader<capture_walking::PreviewUpdateTrigger>
+  {
+    static capture_walking::PreviewUpdateTrigger load(const mc_rtc::Configuration & config)
+    {
+      capture_walking::PreviewUpdateTrigger trigger;
+      std::string mode = "periodic";
+      config("mode", mode);
+      trigger.eventTriggered = (mode == "event");
+      config("contact_drift", trigger.maxContactDrift);
+      config("dcm_error", trigger.maxDCMError);
+      config("max_period", trigger.maxPeriod);
+      config("zmp_margin", trigger.minZMPMargin);
+      return trigger;
+    }
+
+    static mc_rtc::Configuration save(const capture_walking::PreviewUpdateTrigger & trigger)
+    {
+      mc_rtc::Configuration config;
+      config.add("mode", trigger.eventTriggered ? "event" : "periodic");
+      config.add("contact_drift", trigger.maxContactDrift);
+      config.add("dcm_error", trigger.maxDCMError);
+      config.add("max_period", trigger.maxPeriod);
+      config.add("zmp_margin", trigger.minZMPMargin);
+      return config;
+    }
+  };
+}
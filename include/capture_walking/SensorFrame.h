@@ -0,0 +1,111 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <algorithm>
+
+#include <SpaceVecAlg/SpaceVecAlg>
+#include <mc_rbdyn/Robot.h>
+
+namespace capture_walking
+{
+  /** Sensor readings of one control cycle, shared by all their consumers.
+   *
+   * Force sensor and surface names are resolved the first time the frame is
+   * read, so that readings cost no name lookup afterwards. Readings are split
+   * in two stages: read() gathers everything that does not depend on the
+   * floating-base estimate, while updateWorldWrenches() expresses foot
+   * wrenches in the inertial frame once the floating base has been observed.
+   *
+   */
+  struct SensorFrame
+  {
+    /** Readings of a foot force sensor.
+     *
+     */
+    struct Foot
+    {
+      sva::ForceVecd surfaceWrench = sva::ForceVecd(Eigen::Vector6d::Zero()); /**< Wrench in sole surface frame, without gravity of the sensor mass */
+      sva::ForceVecd worldWrench = sva::ForceVecd(Eigen::Vector6d::Zero()); /**< Wrench at the origin of the inertial frame */
+      Eigen::Vector2d cop = Eigen::Vector2d::Zero(); /**< CoP in sole surface frame, zero without pressure [m] */
+      double pressure = 0.; /**< Normal force in sole surface frame [N] */
+      bool isInContact = false; /**< Pressure is above the contact threshold */
+    };
+
+    /** Read force sensors and IMU.
+     *
+     * \param robot Real robot, whose floating base may not be estimated yet.
+     *
+     */
+    void read(const mc_rbdyn::Robot & robot);
+
+    /** Express foot wrenches in the inertial frame and sum them.
+     *
+     * \param robot Real robot with estimated floating base.
+     *
+     */
+    void updateWorldWrenches(const mc_rbdyn::Robot & robot);
+
+    /** Fraction of the total pressure sustained by the left foot.
+     *
+     */
+    double leftFootRatio() const
+    {
+      double leftFootPressure = std::max(0., leftFoot.pressure);
+      double rightFootPressure = std::max(0., rightFoot.pressure);
+      return leftFootPressure / (leftFootPressure + rightFootPressure);
+    }
+
+    /** True if neither foot is in contact.
+     *
+     */
+    bool isInTheAir() const
+    {
+      return !leftFoot.isInContact && !rightFoot.isInContact;
+    }
+
+  private:
+    /** Look up sensor indices and surfaces by name.
+     *
+     * \param robot Robot to look them up in.
+     *
+     */
+    void resolve(const mc_rbdyn::Robot & robot);
+
+  public:
+    Eigen::Matrix3d imuOrientation = Eigen::Matrix3d::Identity(); /**< Rotation from world to IMU frame */
+    Foot leftFoot;
+    Foot rightFoot;
+    sva::ForceVecd netWrench = sva::ForceVecd(Eigen::Vector6d::Zero()); /**< Net contact wrench at the origin of the inertial frame */
+
+  private:
+    const mc_rbdyn::Surface * leftFootSurface_ = nullptr;
+    const mc_rbdyn::Surface * rightFootSurface_ = nullptr;
+    unsigned leftFootSensorIndex_ = 0;
+    unsigned rightFootSensorIndex_ = 0;
+  };
+}
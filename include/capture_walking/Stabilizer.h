@@ -35,8 +35,11 @@
 
 #include <capture_walking/Pendulum.h>
 #include <capture_walking/Contact.h>
+#include <capture_walking/SensorFrame.h>
 #include <capture_walking/Sole.h>
 #include <capture_walking/defs.h>
+#include <capture_walking/utils/ChangeLog.h>
+#include <capture_walking/utils/GroupedLogger.h>
 #include <capture_walking/utils/Integrator.h>
 #include <capture_walking/utils/rotations.h>
 
@@ -113,12 +116,19 @@ namespace capture_walking
      */
     Stabilizer(const mc_rbdyn::Robot & robot, const Pendulum & ref, double dt, std::shared_ptr<mc_tasks::PostureTask> postureTask_);
 
+    /** Add rarely-changing stabilizer parameters to change log.
+     *
+     * \param changes Change log of the controller.
+     *
+     */
+    void addChangeLogEntries(ChangeLog & changes);
+
     /** Add stabilizer entries to logs.
      *
-     * \param logger Logger.
+     * \param logger Grouped logger of the controller.
      *
      */
-    void addLogEntries(mc_rtc::Logger & logger);
+    void addLogEntries(GroupedLogger & logger);
 
     /** Add GUI panel.
      *
@@ -189,17 +199,29 @@ namespace capture_walking
      *
      * \param comd Velocity of the center of mass.
      *
-     * \param wrench Net contact wrench in the inertial frame.
+     * \param sensors Sensor readings of the current cycle.
      *
      * \param leftFootRatio Desired pressure distribution ratio for left foot.
      *
      */
-    void updateState(const Eigen::Vector3d & com, const Eigen::Vector3d & comd, const sva::ForceVecd & wrench, double leftFootRatio = 0.5)
+    void updateState(const Eigen::Vector3d & com, const Eigen::Vector3d & comd, const SensorFrame & sensors, double leftFootRatio = 0.5)
     {
+      leftFootPressure_ = sensors.leftFoot.pressure;
       leftFootRatio_ = leftFootRatio;
       measuredCoM_ = com;
       measuredCoMd_ = comd;
-      measuredWrench_ = wrench;
+      measuredWrench_ = sensors.netWrench;
+      rightFootPressure_ = sensors.rightFoot.pressure;
+    }
+
+    /** Measured pressure under a foot.
+     *
+     * \param footTask One of leftFootTask or rightFootTask.
+     *
+     */
+    double measuredPressure(const std::shared_ptr<mc_tasks::force::CoPTask> & footTask) const
+    {
+      return (footTask == leftFootTask) ? leftFootPressure_ : rightFootPressure_;
     }
 
     /** Add tasks to QP solver.
@@ -265,6 +287,9 @@ namespace capture_walking
      * 
      * \param contact Target contact location.
      *
+     * Does nothing if the foot task already holds the same contact, so that
+     * state transitions do not reset the admittance of planted feet.
+     *
      */
     void setContact(std::shared_ptr<mc_tasks::force::CoPTask> footTask, const Contact & contact);
 
@@ -431,12 +456,15 @@ namespace capture_walking
     QPWeights qpWeights_;
     const Pendulum & pendulum_;
     const mc_rbdyn::Robot & controlRobot_;
+    bool hasLeftFootContact_ = false;
+    bool hasRightFootContact_ = false;
     double comWeight_ = 1000.;
     double contactWeight_ = 100000.;
     double dcmGain_ = 1.;
     double dcmIntegralGain_ = 0.;
     double dfzAdmittance_ = 1e-4;
     double dt_ = 0.005; // [s]
+    double leftFootPressure_ = 0.; // [N]
     double leftFootRatio_ = 0.5;
     double logMeasuredDFz_ = 0.;
     double logMeasuredSTz_ = 0.;
@@ -453,6 +481,7 @@ namespace capture_walking
     double qpNetWrenchCost_ = 0.;
     double qpPressureCost_ = 0.;
     double qpRightAnkleCost_ = 0.;
+    double rightFootPressure_ = 0.; // [N]
     double swingFootStiffness_ = 2000.;
     double swingFootWeight_ = 100.;
     double torsoPitch_ = 0.0; // [rad]
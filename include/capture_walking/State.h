@@ -28,10 +28,18 @@
 #pragma once
 
 #include "Controller.h"
+#include "utils/Tracing.h"
 
 namespace capture_walking
 {
   /** Convenience wrapper for FSM states.
+   *
+   * FSM states are instantiated anew at each transition. To keep transition
+   * cycles light, states register their GUI elements only once per
+   * controller, in addGUIElements(), while log entries and stabilizer tasks
+   * are registered by the controller. Callbacks of GUI elements may outlive
+   * the state that registered them, so they should reach the active state
+   * through Controller::activeState() rather than capture it.
    *
    */
   struct State : mc_control::fsm::State
@@ -48,7 +56,15 @@ namespace capture_walking
      */
     void start(mc_control::fsm::Controller & controller) override
     {
+      CW_TRACE_SPAN((name() + "::start").c_str());
       controller_ = &static_cast<Controller&>(controller);
+      controller_->allocationAudit.enterState(name());
+      controller_->cycleBudget.enterState(name());
+      controller_->activeState(this);
+      if (controller_->isFirstStart(name()))
+      {
+        addGUIElements();
+      }
       start();
     }
 
@@ -70,7 +86,9 @@ namespace capture_walking
      */
     void teardown(mc_control::fsm::Controller &) override
     {
+      CW_TRACE_SPAN((name() + "::teardown").c_str());
       teardown();
+      controller_->activeState(nullptr);
     }
 
     /** Get controller.
@@ -121,7 +139,23 @@ namespace capture_walking
       return controller_->stabilizer();
     }
 
+    /** Register GUI elements, called the first time the state starts.
+     *
+     */
+    virtual void addGUIElements()
+    {
+    }
+
+    /** Remaining time in the current walking phase, reported in logs.
+     *
+     */
+    virtual double remPhaseTime() const
+    {
+      return 0.;
+    }
+
     virtual bool checkTransitions() = 0;
+    virtual WalkingPhase phase() const = 0;
     virtual void runState() = 0;
     virtual void start() = 0;
     virtual void teardown() = 0;
@@ -0,0 +1,90 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <capture_walking/Contact.h>
+#include <capture_walking/Pendulum.h>
+#include <capture_walking/Preview.h>
+#include <capture_walking/defs.h>
+
+namespace capture_walking
+{
+  /** Closed-form stopping trajectory for the linear inverted pendulum.
+   *
+   * The ZMP is set once and for all to the capture point, projected on the
+   * support contact and clamped inside its area. When the capture point lies
+   * inside the contact area, the DCM stays still and the CoM converges to
+   * it. Otherwise the ZMP is put as close as possible to it.
+   *
+   * Only horizontal dynamics are integrated: the CoM height above the
+   * contact is kept at its value when the preview is computed, and the
+   * pendulum stiffness is derived from it.
+   *
+   * This preview is cheap to compute and is used as a fallback reference
+   * while walking pattern generators fail to find a solution.
+   *
+   * \note A single failed solve replaces the current preview with this one,
+   * even if the former was still valid, so that the robot starts stopping
+   * until the next successful solve.
+   *
+   */
+  struct StoppingPreview : public Preview
+  {
+    /** Compute stopping trajectory from a given state.
+     *
+     * \param state Current state of the reference pendulum.
+     *
+     * \param contact Support contact to stop on.
+     *
+     */
+    StoppingPreview(const Pendulum & state, const Contact & contact);
+
+    /** Integrate stopping trajectory.
+     *
+     * \param state CoM state to integrate upon.
+     *
+     * \param dt Duration.
+     *
+     */
+    void integrate(Pendulum & state, double dt) override;
+
+    /** ZMP of the stopping trajectory.
+     *
+     */
+    const Eigen::Vector3d & zmp() const
+    {
+      return zmp_;
+    }
+
+  private:
+    Contact contact_;
+    Eigen::Vector3d zmp_;
+    double comHeight_; // [m]
+    double lambda_;
+  };
+}
@@ -0,0 +1,61 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace capture_walking
+{
+  /** Default path of the footstep stream socket.
+   *
+   */
+  constexpr const char * FOOTSTEP_STREAM_SOCKET = "/tmp/capture_walking_footsteps.sock";
+
+  /** Magic number identifying footstep stream datagrams.
+   *
+   */
+  constexpr uint32_t FOOTSTEP_STREAM_MAGIC = 0x43574653; // "CWFS"
+
+  /** Upcoming footstep sent by an external planner, one per datagram.
+   *
+   * The binary layout only depends on fixed-size types so that producers do
+   * not need to link against the controller.
+   *
+   */
+  struct StreamedFootstep
+  {
+    uint32_t magic = FOOTSTEP_STREAM_MAGIC;
+    uint32_t surface = 0; // 1 for LeftFootCenter, 2 for RightFootCenter
+    uint32_t pauseAfterSwing = 0;
+    uint32_t reserved = 0;
+    double position[3] = {0., 0., 0.}; // [m]
+    double rpy[3] = {0., 0., 0.}; // [rad]
+    double halfLength = 0.; // [m], zero for sole default
+    double halfWidth = 0.; // [m], zero for sole default
+  };
+}
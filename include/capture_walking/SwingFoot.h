@@ -28,8 +28,8 @@
 #pragma once
 
 #include <SpaceVecAlg/SpaceVecAlg>
-#include <mc_rtc/log/Logger.h>
 
+#include <capture_walking/utils/GroupedLogger.h>
 #include <capture_walking/utils/polynomials.h>
 
 namespace capture_walking
@@ -59,17 +59,10 @@ namespace capture_walking
 
     /** Add swing foot entries to log.
      *
-     * \param logger Logger.
+     * \param logger Grouped logger, entries go to the "wpg" group.
      *
      */
-    void addLogEntries(mc_rtc::Logger & logger);
-
-    /** Remove swing foot entries from log.
-     *
-     * \param logger Logger.
-     *
-     */
-    void removeLogEntries(mc_rtc::Logger & logger);
+    void addLogEntries(GroupedLogger & logger);
 
     /** Progress by dt along the swing foot trajectory.
      *
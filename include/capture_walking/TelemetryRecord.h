@@ -0,0 +1,101 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+namespace capture_walking
+{
+  /** Default name of the shared-memory telemetry segment.
+   *
+   */
+  constexpr const char * TELEMETRY_SEGMENT = "/capture_walking_telemetry";
+
+  /** Telemetry record written by the controller once per control cycle.
+   *
+   * The record only contains doubles so that its binary layout is the same in
+   * every process on the machine. Vectors are stored as (x, y, z) triplets.
+   * Append new fields at the end and update TELEMETRY_COLUMNS accordingly.
+   *
+   */
+  struct TelemetryRecord
+  {
+    double time; // [s]
+    double pendulumCom[3];
+    double pendulumComd[3];
+    double pendulumZMP[3];
+    double pendulumOmega;
+    double observerCom[3];
+    double observerComd[3];
+    double observerZMP[3];
+    double realCom[3];
+    double realComd[3];
+    double distribZMP[3];
+    double leftFootRatio;
+    double leftFootCoP[2]; // in surface frame
+    double leftFootForce[3];
+    double rightFootCoP[2]; // in surface frame
+    double rightFootForce[3];
+    double previewPlaybackStep; // negative when there is no preview
+    double previewPlaybackTime; // [s]
+    double supportContact[3];
+    double targetContact[3];
+  };
+
+  /** Number of doubles in a telemetry record.
+   *
+   */
+  constexpr unsigned TELEMETRY_NB_COLUMNS = sizeof(TelemetryRecord) / sizeof(double);
+
+  /** Column names, in record order.
+   *
+   */
+  constexpr const char * TELEMETRY_COLUMNS[] = {
+    "time",
+    "pendulum_com_x", "pendulum_com_y", "pendulum_com_z",
+    "pendulum_comd_x", "pendulum_comd_y", "pendulum_comd_z",
+    "pendulum_zmp_x", "pendulum_zmp_y", "pendulum_zmp_z",
+    "pendulum_omega",
+    "observer_com_x", "observer_com_y", "observer_com_z",
+    "observer_comd_x", "observer_comd_y", "observer_comd_z",
+    "observer_zmp_x", "observer_zmp_y", "observer_zmp_z",
+    "real_com_x", "real_com_y", "real_com_z",
+    "real_comd_x", "real_comd_y", "real_comd_z",
+    "distrib_zmp_x", "distrib_zmp_y", "distrib_zmp_z",
+    "left_foot_ratio",
+    "left_foot_cop_x", "left_foot_cop_y",
+    "left_foot_force_x", "left_foot_force_y", "left_foot_force_z",
+    "right_foot_cop_x", "right_foot_cop_y",
+    "right_foot_force_x", "right_foot_force_y", "right_foot_force_z",
+    "preview_playback_step",
+    "preview_playback_time",
+    "support_contact_x", "support_contact_y", "support_contact_z",
+    "target_contact_x", "target_contact_y", "target_contact_z"
+  };
+
+  static_assert(sizeof(TelemetryRecord) == TELEMETRY_NB_COLUMNS * sizeof(double), "telemetry record must be made of doubles only");
+  static_assert(sizeof(TELEMETRY_COLUMNS) / sizeof(TELEMETRY_COLUMNS[0]) == TELEMETRY_NB_COLUMNS, "telemetry column names are out of sync with record");
+}
@@ -0,0 +1,104 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <array>
+
+#include <SpaceVecAlg/SpaceVecAlg>
+
+namespace capture_walking
+{
+  /** Maximum number of plan footsteps displayed at any time.
+   *
+   */
+  constexpr unsigned FOOTSTEP_WINDOW_SIZE = 16;
+
+  /** Number of past footsteps kept in the displayed window.
+   *
+   */
+  constexpr unsigned FOOTSTEP_WINDOW_BEHIND = 2;
+
+  /** Window of plan footsteps around the current one.
+   *
+   * Unlike VisualizationSnapshot, a new window is only published when the
+   * plan changes, i.e. at most once per footstep.
+   *
+   */
+  struct FootstepWindow
+  {
+    std::array<sva::PTransformd, FOOTSTEP_WINDOW_SIZE> poses;
+    double soleHalfLength = 0.; // [m]
+    double soleHalfWidth = 0.; // [m]
+    sva::PTransformd supportPose = sva::PTransformd::Identity();
+    sva::PTransformd targetPose = sva::PTransformd::Identity();
+    unsigned firstIndex = 0; // index of poses[0] in the plan
+    unsigned nbFootsteps = 0;
+  };
+
+  /** Fixed-size copy of the controller state needed by ROS visualization.
+   *
+   * Snapshots are filled by the control thread once per cycle and read by the
+   * ROS spinner, which never touches the controller state directly.
+   *
+   */
+  struct VisualizationSnapshot
+  {
+    /** Force sensor readings and stabilizer target of a foot.
+     *
+     */
+    struct Foot
+    {
+      Eigen::Vector3d force = Eigen::Vector3d::Zero(); // in surface frame
+      Eigen::Vector3d measuredCoP = Eigen::Vector3d::Zero(); // in surface frame
+      Eigen::Vector3d targetCoP = Eigen::Vector3d::Zero(); // in surface frame
+    };
+
+    /** Inverted pendulum state.
+     *
+     */
+    struct Pendulum
+    {
+      Eigen::Vector3d com = Eigen::Vector3d::Zero();
+      Eigen::Vector3d contactForce = Eigen::Vector3d::Zero();
+      Eigen::Vector3d zmp = Eigen::Vector3d::Zero();
+    };
+
+    Eigen::Vector3d controlCom = Eigen::Vector3d::Zero();
+    Eigen::Vector3d controlDcm = Eigen::Vector3d::Zero();
+    Eigen::Vector3d distribZMP = Eigen::Vector3d::Zero();
+    Eigen::Vector3d realCom = Eigen::Vector3d::Zero();
+    Eigen::Vector3d realDcm = Eigen::Vector3d::Zero();
+    Foot leftFoot;
+    Foot rightFoot;
+    Pendulum pendulum;
+    Pendulum pendulumObserver;
+    sva::PTransformd X_0_inertial = sva::PTransformd::Identity();
+    sva::PTransformd supportPose = sva::PTransformd::Identity();
+    sva::PTransformd targetPose = sva::PTransformd::Identity();
+  };
+}
@@ -40,4 +40,24 @@ namespace capture_walking
   }
 
   const Eigen::Vector3d e_z = {0., 0., 1.};
+
+  /** Phases of the walking FSM, with their values in logs.
+   *
+   */
+  enum class WalkingPhase : int
+  {
+    Initial = -2,
+    SingleSupport = 1,
+    DoubleSupport = 2,
+    Standing = 3
+  };
+
+  /** Walking pattern generation methods.
+   *
+   */
+  enum class WalkingPatternGeneration
+  {
+    CaptureProblem,
+    HorizontalMPC
+  };
 }
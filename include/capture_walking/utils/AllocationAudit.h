@@ -0,0 +1,227 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <dlfcn.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace capture_walking
+{
+  /** Heap allocation counters of a thread.
+   *
+   */
+  struct AllocationCounters
+  {
+    uint64_t nbAllocations = 0;
+    uint64_t nbBytes = 0;
+  };
+
+  /** Per-cycle and per-state audit of heap allocations in the control loop.
+   *
+   * Counting relies on the capture_walking_controller_alloc_audit hook library, which
+   * interposes malloc and its variants when loaded with LD_PRELOAD and keeps
+   * counters per thread. Without it the audit is unavailable and costs a
+   * single branch per cycle.
+   *
+   */
+  class AllocationAudit
+  {
+  public:
+    /** Allocation statistics of an FSM state.
+     *
+     */
+    struct StateStats
+    {
+      std::string name;
+      uint64_t nbAllocatingCycles = 0;
+      uint64_t nbAllocations = 0;
+      uint64_t nbBytes = 0;
+      uint64_t nbCycles = 0;
+    };
+
+    /** Look up the allocation hook library.
+     *
+     */
+    AllocationAudit()
+    {
+      getCounters_ = reinterpret_cast<CountersGetter>(dlsym(RTLD_DEFAULT, "cw_thread_allocation_counters"));
+    }
+
+    /** Check whether the allocation hook library is loaded.
+     *
+     */
+    bool isAvailable() const
+    {
+      return (getCounters_ != nullptr);
+    }
+
+    /** Check whether steady-state cycles are required not to allocate.
+     *
+     */
+    bool strict() const
+    {
+      return isStrict_;
+    }
+
+    /** Require steady-state cycles not to allocate.
+     *
+     * \param strict Whether the control loop should fail on allocations.
+     *
+     */
+    void strict(bool strict)
+    {
+      isStrict_ = strict;
+    }
+
+    /** Set FSM states where walking is in steady state.
+     *
+     * \param names State names.
+     *
+     */
+    void steadyStates(const std::vector<std::string> & names)
+    {
+      steadyStates_ = names;
+    }
+
+    /** Start counting allocations of the calling thread.
+     *
+     */
+    void startCycle()
+    {
+      if (getCounters_)
+      {
+        cycleStart_ = *getCounters_();
+      }
+    }
+
+    /** Stop counting and update statistics.
+     *
+     * \param isPreviewUpdate Whether the walking preview was updated during
+     * the cycle, which makes it a non-steady cycle.
+     *
+     */
+    void endCycle(bool isPreviewUpdate)
+    {
+      if (!getCounters_)
+      {
+        return;
+      }
+      const AllocationCounters & counters = *getCounters_();
+      cycle_.nbAllocations = counters.nbAllocations - cycleStart_.nbAllocations;
+      cycle_.nbBytes = counters.nbBytes - cycleStart_.nbBytes;
+      isSteadyCycle_ = isSteadyState_ && !isStateStart_ && !isPreviewUpdate;
+      isStateStart_ = false;
+      if (stateIndex_ < stateStats_.size())
+      {
+        StateStats & stats = stateStats_[stateIndex_];
+        stats.nbAllocations += cycle_.nbAllocations;
+        stats.nbBytes += cycle_.nbBytes;
+        stats.nbCycles++;
+        if (cycle_.nbAllocations > 0)
+        {
+          stats.nbAllocatingCycles++;
+        }
+      }
+    }
+
+    /** Attribute subsequent cycles to an FSM state.
+     *
+     * \param name State name.
+     *
+     * \note Only allocates the first time a state is entered.
+     *
+     */
+    void enterState(const std::string & name)
+    {
+      isStateStart_ = true;
+      isSteadyState_ = (std::find(steadyStates_.begin(), steadyStates_.end(), name) != steadyStates_.end());
+      for (stateIndex_ = 0; stateIndex_ < stateStats_.size(); stateIndex_++)
+      {
+        if (stateStats_[stateIndex_].name == name)
+        {
+          return;
+        }
+      }
+      stateStats_.emplace_back();
+      stateStats_.back().name = name;
+    }
+
+    /** Allocations during the last cycle.
+     *
+     */
+    const AllocationCounters & cycle() const
+    {
+      return cycle_;
+    }
+
+    /** Check whether the last cycle was a steady-state cycle that allocated.
+     *
+     * Steady-state cycles are cycles of the steady states, excluding the
+     * first cycle of each state and cycles where the preview was updated.
+     *
+     */
+    bool isSteadyStateViolation() const
+    {
+      return (isSteadyCycle_ && cycle_.nbAllocations > 0);
+    }
+
+    /** Allocation statistics of FSM states entered so far.
+     *
+     */
+    const std::vector<StateStats> & stateStats() const
+    {
+      return stateStats_;
+    }
+
+    /** Total allocations in the current FSM state.
+     *
+     */
+    uint64_t stateAllocations() const
+    {
+      return (stateIndex_ < stateStats_.size()) ? stateStats_[stateIndex_].nbAllocations : 0;
+    }
+
+  private:
+    using CountersGetter = const AllocationCounters * (*)();
+
+    AllocationCounters cycleStart_;
+    AllocationCounters cycle_;
+    CountersGetter getCounters_ = nullptr;
+    bool isStateStart_ = false;
+    bool isSteadyCycle_ = false;
+    bool isSteadyState_ = false;
+    bool isStrict_ = false;
+    std::vector<StateStats> stateStats_;
+    std::vector<std::string> steadyStates_ = {"DoubleSupport", "SingleSupport"};
+    unsigned stateIndex_ = 0;
+  };
+}
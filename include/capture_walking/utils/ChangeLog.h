@@ -0,0 +1,235 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <SpaceVecAlg/SpaceVecAlg>
+
+namespace capture_walking
+{
+  /** Event log of rarely-changing values.
+   *
+   * Registered values are polled at a low rate and written to a CSV file only
+   * when they change, one line per event:
+   *
+   *     time,name,value_0[,value_1,...]
+   *
+   * The tools/changelog_reconstruct program turns this file back into full
+   * time series, optionally aligned on the timestamps of a regular log.
+   *
+   */
+  class ChangeLog
+  {
+  public:
+    /** Maximum number of scalars in a value.
+     *
+     */
+    static constexpr unsigned MAX_SIZE = 6;
+
+    /** Fixed-size buffer holding a polled value.
+     *
+     */
+    using Values = std::array<double, MAX_SIZE>;
+
+    ChangeLog() = default;
+    ChangeLog(const ChangeLog &) = delete;
+    ChangeLog & operator=(const ChangeLog &) = delete;
+
+    ~ChangeLog()
+    {
+      close();
+    }
+
+    /** Register a value.
+     *
+     * \param name Name of the value.
+     *
+     * \param callback Function returning the value, either a scalar, a fixed-size
+     * Eigen vector or a spatial vector.
+     *
+     */
+    template <typename CallbackT>
+    void addEntry(const std::string & name, CallbackT callback)
+    {
+      Entry entry;
+      entry.name = name;
+      entry.read = [callback](Values & values) { return toValues(callback(), values); };
+      entries_.push_back(entry);
+    }
+
+    /** Close output file.
+     *
+     */
+    void close()
+    {
+      if (file_)
+      {
+        std::fclose(file_);
+        file_ = nullptr;
+      }
+    }
+
+    /** True if the output file is open.
+     *
+     */
+    bool isOpen() const
+    {
+      return (file_ != nullptr);
+    }
+
+    /** Open output file.
+     *
+     * \param path Path to output CSV file.
+     *
+     * \returns True if the file was successfully opened.
+     *
+     */
+    bool open(const std::string & path)
+    {
+      close();
+      file_ = std::fopen(path.c_str(), "w");
+      if (!file_)
+      {
+        return false;
+      }
+      std::fprintf(file_, "time,name,values\n");
+      for (auto & entry : entries_)
+      {
+        entry.isSet = false; // write all values again at first poll
+      }
+      return true;
+    }
+
+    /** Get polling period.
+     *
+     */
+    double period() const
+    {
+      return period_;
+    }
+
+    /** Set polling period.
+     *
+     * \param period New period in [s].
+     *
+     */
+    void period(double period)
+    {
+      period_ = period;
+    }
+
+    /** Poll all values and write those that changed.
+     *
+     * \param time Current controller time.
+     *
+     */
+    void poll(double time)
+    {
+      if (!file_)
+      {
+        return;
+      }
+      Values values;
+      for (auto & entry : entries_)
+      {
+        unsigned size = entry.read(values);
+        if (entry.isSet && values == entry.last)
+        {
+          continue;
+        }
+        std::fprintf(file_, "%.6f,%s", time, entry.name.c_str());
+        for (unsigned i = 0; i < size; i++)
+        {
+          std::fprintf(file_, ",%.9g", values[i]);
+        }
+        std::fprintf(file_, "\n");
+        entry.last = values;
+        entry.isSet = true;
+      }
+      lastPollTime_ = time;
+    }
+
+    /** Poll values if the polling period has elapsed.
+     *
+     * \param time Current controller time.
+     *
+     */
+    void update(double time)
+    {
+      if (time - lastPollTime_ >= period_)
+      {
+        poll(time);
+      }
+    }
+
+  private:
+    struct Entry
+    {
+      std::string name;
+      std::function<unsigned(Values &)> read;
+      Values last;
+      bool isSet = false;
+    };
+
+    static unsigned toValues(double value, Values & values)
+    {
+      values.fill(0.);
+      values[0] = value;
+      return 1;
+    }
+
+    template <typename Derived>
+    static unsigned toValues(const Eigen::MatrixBase<Derived> & vec, Values & values)
+    {
+      static_assert(Derived::SizeAtCompileTime > 0 && Derived::SizeAtCompileTime <= MAX_SIZE, "change-log values must be small fixed-size vectors");
+      values.fill(0.);
+      for (unsigned i = 0; i < Derived::SizeAtCompileTime; i++)
+      {
+        values[i] = vec(i);
+      }
+      return Derived::SizeAtCompileTime;
+    }
+
+    static unsigned toValues(const sva::ForceVecd & wrench, Values & values)
+    {
+      const Eigen::Vector6d vec = wrench.vector();
+      return toValues(vec, values);
+    }
+
+  private:
+    FILE * file_ = nullptr;
+    double lastPollTime_ = -1e10; // [s]
+    double period_ = 0.1; // [s]
+    std::vector<Entry> entries_;
+  };
+}
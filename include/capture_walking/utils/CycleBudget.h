@@ -0,0 +1,405 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace capture_walking
+{
+  /** Sections of the control cycle timed by the cycle budget monitor.
+   *
+   * Preview and Stabilizer sections are nested inside the FSM section, while
+   * the Total section spans the whole of Controller::run().
+   *
+   */
+  enum class CycleSection : unsigned
+  {
+    Observers = 0,
+    FSM,
+    Preview,
+    Stabilizer,
+    Total
+  };
+
+  constexpr unsigned NB_CYCLE_SECTIONS = 5;
+  constexpr unsigned LATENCY_BINS_PER_DECADE = 40;
+  constexpr unsigned LATENCY_NB_DECADES = 6;
+  constexpr unsigned LATENCY_NB_BINS = LATENCY_BINS_PER_DECADE * LATENCY_NB_DECADES;
+  constexpr double LATENCY_MIN_DURATION = 1e-6; // [s]
+
+  /** Streaming histogram of durations with logarithmically-spaced bins.
+   *
+   * Bins cover durations from 1 us to 1 s with 40 bins per decade, so that
+   * percentiles are estimated with a relative resolution of about 6% in
+   * constant memory and time.
+   *
+   */
+  class LatencyHistogram
+  {
+  public:
+    /** Add a new duration to the histogram.
+     *
+     * \param duration Duration in [s].
+     *
+     */
+    void add(double duration)
+    {
+      unsigned bin = 0;
+      if (duration > LATENCY_MIN_DURATION)
+      {
+        double x = LATENCY_BINS_PER_DECADE * std::log10(duration / LATENCY_MIN_DURATION);
+        bin = (x < LATENCY_NB_BINS - 1) ? static_cast<unsigned>(x) : LATENCY_NB_BINS - 1;
+      }
+      counts_[bin]++;
+      n_++;
+      if (duration > max_)
+      {
+        max_ = duration;
+      }
+    }
+
+    /** Maximum duration since last reset.
+     *
+     */
+    double max() const
+    {
+      return max_;
+    }
+
+    /** Number of samples since last reset.
+     *
+     */
+    uint64_t n() const
+    {
+      return n_;
+    }
+
+    /** Estimate percentile of the distribution.
+     *
+     * \param p Fraction between 0 and 1, e.g. 0.99 for the 99th percentile.
+     *
+     * \returns Upper bound of the bin containing the percentile, capped by
+     * the maximum duration.
+     *
+     */
+    double percentile(double p) const
+    {
+      if (n_ == 0)
+      {
+        return 0.;
+      }
+      uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p * n_)));
+      uint64_t count = 0;
+      for (unsigned bin = 0; bin < LATENCY_NB_BINS; bin++)
+      {
+        count += counts_[bin];
+        if (count >= rank)
+        {
+          double upper = LATENCY_MIN_DURATION * std::pow(10., static_cast<double>(bin + 1) / LATENCY_BINS_PER_DECADE);
+          return std::min(upper, max_);
+        }
+      }
+      return max_;
+    }
+
+    /** Reset histogram to empty distribution.
+     *
+     */
+    void reset()
+    {
+      counts_.fill(0);
+      max_ = 0.;
+      n_ = 0;
+    }
+
+  private:
+    std::array<uint64_t, LATENCY_NB_BINS> counts_ = {};
+    double max_ = 0.;
+    uint64_t n_ = 0;
+  };
+
+  /** Per-cycle budget monitor of the control loop.
+   *
+   * Each section of the control cycle is timed with a monotonic clock and
+   * accumulated into a latency histogram. Cycles whose total duration
+   * exceeds the budget are counted as overruns and attributed to the FSM
+   * state active during the cycle. Total durations of transition cycles,
+   * i.e. cycles where a state is entered, are also kept apart from those of
+   * steady-state cycles. The cost is a few clock reads and one
+   * logarithm per section, so that the monitor can stay enabled in
+   * production.
+   *
+   */
+  class CycleBudget
+  {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    /** Overrun statistics of an FSM state.
+     *
+     */
+    struct StateStats
+    {
+      std::string name;
+      double maxDuration = 0.; // [s]
+      double maxTransitionDuration = 0.; // [s] of cycles entering the state
+      uint64_t nbCycles = 0;
+      uint64_t nbOverruns = 0;
+    };
+
+    /** Time a section until the end of the enclosing scope.
+     *
+     */
+    class ScopedSection
+    {
+    public:
+      ScopedSection(CycleBudget & budget, CycleSection section)
+        : budget_(budget),
+          section_(section),
+          start_(clock::now())
+      {
+      }
+
+      ~ScopedSection()
+      {
+        budget_.addToSection(section_, start_);
+      }
+
+    private:
+      CycleBudget & budget_;
+      CycleSection section_;
+      clock::time_point start_;
+    };
+
+    /** Set cycle budget.
+     *
+     * \param budget Maximum duration of a control cycle in [s].
+     *
+     */
+    void budget(double budget)
+    {
+      budget_ = budget;
+    }
+
+    /** Get cycle budget in [s].
+     *
+     */
+    double budget() const
+    {
+      return budget_;
+    }
+
+    /** Start a new control cycle.
+     *
+     */
+    void startCycle()
+    {
+      durations_.fill(0.);
+      isTransition_ = false;
+      cycleStart_ = clock::now();
+    }
+
+    /** Add elapsed time since a given instant to a section.
+     *
+     * \param section Section of the control cycle.
+     *
+     * \param start Instant when the section started.
+     *
+     * \note Durations accumulate when a section runs several times in the
+     * same cycle.
+     *
+     */
+    void addToSection(CycleSection section, clock::time_point start)
+    {
+      durations_[static_cast<unsigned>(section)] += std::chrono::duration<double>(clock::now() - start).count();
+    }
+
+    /** Close the current cycle and update statistics.
+     *
+     */
+    void endCycle()
+    {
+      addToSection(CycleSection::Total, cycleStart_);
+      for (unsigned i = 0; i < NB_CYCLE_SECTIONS; i++)
+      {
+        if (durations_[i] > 0.)
+        {
+          histograms_[i].add(durations_[i]);
+        }
+      }
+      double total = duration(CycleSection::Total);
+      if (isTransition_)
+      {
+        transitionHistogram_.add(total);
+      }
+      else
+      {
+        steadyHistogram_.add(total);
+      }
+      bool isOverrun = (budget_ > 0. && total > budget_);
+      if (isOverrun)
+      {
+        nbOverruns_++;
+      }
+      if (stateIndex_ < stateStats_.size())
+      {
+        StateStats & stats = stateStats_[stateIndex_];
+        stats.nbCycles++;
+        stats.maxDuration = std::max(stats.maxDuration, total);
+        if (isTransition_)
+        {
+          stats.maxTransitionDuration = std::max(stats.maxTransitionDuration, total);
+        }
+        if (isOverrun)
+        {
+          stats.nbOverruns++;
+        }
+      }
+    }
+
+    /** Attribute subsequent cycles to an FSM state.
+     *
+     * \param name State name.
+     *
+     * \note Only allocates the first time a state is entered.
+     *
+     */
+    void enterState(const std::string & name)
+    {
+      isTransition_ = true;
+      for (stateIndex_ = 0; stateIndex_ < stateStats_.size(); stateIndex_++)
+      {
+        if (stateStats_[stateIndex_].name == name)
+        {
+          return;
+        }
+      }
+      stateStats_.emplace_back();
+      stateStats_.back().name = name;
+    }
+
+    /** Duration of a section during the last cycle, zero if it did not run.
+     *
+     * \param section Section of the control cycle.
+     *
+     */
+    double duration(CycleSection section) const
+    {
+      return durations_[static_cast<unsigned>(section)];
+    }
+
+    /** Latency histogram of a section.
+     *
+     * \param section Section of the control cycle.
+     *
+     */
+    const LatencyHistogram & histogram(CycleSection section) const
+    {
+      return histograms_[static_cast<unsigned>(section)];
+    }
+
+    /** True if a state was entered during the last cycle.
+     *
+     */
+    bool isTransition() const
+    {
+      return isTransition_;
+    }
+
+    /** Latency histogram of the total duration of steady-state cycles.
+     *
+     */
+    const LatencyHistogram & steadyHistogram() const
+    {
+      return steadyHistogram_;
+    }
+
+    /** Latency histogram of the total duration of transition cycles.
+     *
+     */
+    const LatencyHistogram & transitionHistogram() const
+    {
+      return transitionHistogram_;
+    }
+
+    /** Total number of overruns since last reset.
+     *
+     */
+    uint64_t nbOverruns() const
+    {
+      return nbOverruns_;
+    }
+
+    /** Overrun statistics of FSM states entered so far.
+     *
+     */
+    const std::vector<StateStats> & stateStats() const
+    {
+      return stateStats_;
+    }
+
+    /** Reset all statistics, keeping the list of known states.
+     *
+     */
+    void reset()
+    {
+      for (auto & histogram : histograms_)
+      {
+        histogram.reset();
+      }
+      steadyHistogram_.reset();
+      transitionHistogram_.reset();
+      for (auto & stats : stateStats_)
+      {
+        stats.maxDuration = 0.;
+        stats.maxTransitionDuration = 0.;
+        stats.nbCycles = 0;
+        stats.nbOverruns = 0;
+      }
+      nbOverruns_ = 0;
+    }
+
+  private:
+    clock::time_point cycleStart_;
+    double budget_ = 0.; // [s]
+    LatencyHistogram steadyHistogram_;
+    LatencyHistogram transitionHistogram_;
+    bool isTransition_ = false;
+    std::array<LatencyHistogram, NB_CYCLE_SECTIONS> histograms_;
+    std::array<double, NB_CYCLE_SECTIONS> durations_ = {};
+    std::vector<StateStats> stateStats_;
+    uint64_t nbOverruns_ = 0;
+    unsigned stateIndex_ = 0;
+  };
+}
@@ -0,0 +1,391 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <mc_rtc/logging.h>
+
+#include <capture_walking/utils/ThreadPolicy.h>
+
+namespace capture_walking
+{
+  /** Rate-limiting state of a deferred log call site.
+   *
+   * Sites are registered to the log on their first suppressed message, so
+   * that suppressed counts are reported even if the site goes quiet.
+   *
+   */
+  struct DeferredLogSite
+  {
+    std::atomic<int64_t> lastPushTime{INT64_MIN / 2}; // [ns]
+    std::atomic<unsigned> nbSuppressed{0};
+    std::atomic<bool> isRegistered{false};
+    DeferredLogSite * next = nullptr;
+    const char * format = nullptr;
+    int level = 0;
+  };
+
+  /** Lock-free logging of warnings and errors from the control loop.
+   *
+   * Messages are pushed to a bounded multi-producer single-consumer ring
+   * (Vyukov's algorithm) without formatting nor allocation: a message is only
+   * a format string with "{}" placeholders and up to four arguments that are
+   * either numbers or strings with static lifetime. A background thread
+   * formats and prints them through mc_rtc logging.
+   *
+   * Each call site emits at most one message per MIN_SITE_PERIOD, and the
+   * number of messages suppressed in between is reported with the next one,
+   * or by the background thread once the site has been quiet for a period.
+   * Messages pushed while the ring is full are dropped and counted.
+   *
+   */
+  class DeferredLog
+  {
+  public:
+    /** Severity levels.
+     *
+     */
+    enum class Level
+    {
+      Info,
+      Warning,
+      Error
+    };
+
+    /** Maximum number of arguments of a message.
+     *
+     */
+    static constexpr unsigned MAX_ARGS = 4;
+
+    /** Minimum time between two messages from the same call site, in [ns].
+     *
+     */
+    static constexpr int64_t MIN_SITE_PERIOD = 1000000000;
+
+    /** Number of message slots in the ring.
+     *
+     */
+    static constexpr unsigned RING_SIZE = 256;
+
+    /** Get process-wide instance, starting its thread on first call.
+     *
+     */
+    static DeferredLog & instance()
+    {
+      static DeferredLog log;
+      return log;
+    }
+
+    DeferredLog(const DeferredLog &) = delete;
+    DeferredLog & operator=(const DeferredLog &) = delete;
+
+    /** Set CPU affinity and scheduling of the drain thread.
+     *
+     * \param policy Thread policy.
+     *
+     */
+    void threadPolicy(const ThreadPolicy & policy)
+    {
+      policy.apply(thread_);
+    }
+
+    ~DeferredLog()
+    {
+      isRunning_ = false;
+      if (thread_.joinable())
+      {
+        thread_.join();
+      }
+    }
+
+    /** Number of messages dropped because the ring was full.
+     *
+     */
+    unsigned nbDropped() const
+    {
+      return nbDropped_.load(std::memory_order_relaxed);
+    }
+
+    /** Push message to the ring.
+     *
+     * \param site Call site.
+     *
+     * \param level Severity level.
+     *
+     * \param format Format string with "{}" placeholders.
+     *
+     * \param args Arguments, numbers or static strings.
+     *
+     */
+    template <typename... Args>
+    void push(DeferredLogSite & site, Level level, const char * format, Args... args)
+    {
+      static_assert(sizeof...(Args) <= MAX_ARGS, "too many arguments to deferred log message");
+      int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+      int64_t last = site.lastPushTime.load(std::memory_order_relaxed);
+      if (now - last < MIN_SITE_PERIOD || !site.lastPushTime.compare_exchange_strong(last, now, std::memory_order_relaxed))
+      {
+        site.nbSuppressed.fetch_add(1, std::memory_order_relaxed);
+        if (!site.isRegistered.exchange(true, std::memory_order_relaxed))
+        {
+          registerSite(site, level, format);
+        }
+        return;
+      }
+      uint64_t pos = enqueuePos_.load(std::memory_order_relaxed);
+      Cell * cell;
+      while (true)
+      {
+        cell = &ring_[pos % RING_SIZE];
+        uint64_t seq = cell->seq.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+        if (diff == 0)
+        {
+          if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          {
+            break;
+          }
+        }
+        else if (diff < 0)
+        {
+          nbDropped_.fetch_add(1, std::memory_order_relaxed);
+          return;
+        }
+        else
+        {
+          pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+      }
+      Message & message = cell->message;
+      message.format = format;
+      message.level = level;
+      message.nbArgs = 0;
+      message.nbSuppressed = site.nbSuppressed.exchange(0, std::memory_order_relaxed);
+      setArgs(message, args...);
+      cell->seq.store(pos + 1, std::memory_order_release);
+    }
+
+  private:
+    struct Arg
+    {
+      const char * string;
+      double number;
+    };
+
+    struct Message
+    {
+      Level level;
+      const char * format;
+      std::array<Arg, MAX_ARGS> args;
+      unsigned nbArgs;
+      unsigned nbSuppressed;
+    };
+
+    struct Cell
+    {
+      std::atomic<uint64_t> seq;
+      Message message;
+    };
+
+  private:
+    DeferredLog()
+    {
+      for (unsigned i = 0; i < RING_SIZE; i++)
+      {
+        ring_[i].seq.store(i, std::memory_order_relaxed);
+      }
+      thread_ = std::thread(&DeferredLog::drain, this);
+    }
+
+    /** Add call site to the list of sites whose suppressed counts are
+     * flushed by the background thread.
+     *
+     */
+    void registerSite(DeferredLogSite & site, Level level, const char * format)
+    {
+      site.format = format;
+      site.level = static_cast<int>(level);
+      DeferredLogSite * head = sites_.load(std::memory_order_relaxed);
+      do
+      {
+        site.next = head;
+      } while (!sites_.compare_exchange_weak(head, &site, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    /** Report suppressed messages of call sites that have been quiet for
+     * more than MIN_SITE_PERIOD.
+     *
+     * \param now Current time in [ns].
+     *
+     */
+    void flushSuppressed(int64_t now)
+    {
+      for (DeferredLogSite * site = sites_.load(std::memory_order_acquire); site; site = site->next)
+      {
+        if (site->nbSuppressed.load(std::memory_order_relaxed) == 0 ||
+            now - site->lastPushTime.load(std::memory_order_relaxed) < MIN_SITE_PERIOD)
+        {
+          continue; // nothing to report, or next message will report it
+        }
+        Message message;
+        message.format = site->format;
+        message.level = static_cast<Level>(site->level);
+        message.nbArgs = 0;
+        message.nbSuppressed = site->nbSuppressed.exchange(0, std::memory_order_relaxed);
+        if (message.nbSuppressed > 0)
+        {
+          print(message);
+        }
+      }
+    }
+
+    static void setArgs(Message &)
+    {
+    }
+
+    template <typename... Args>
+    static void setArgs(Message & message, const char * string, Args... args)
+    {
+      message.args[message.nbArgs++] = {string, 0.};
+      setArgs(message, args...);
+    }
+
+    template <typename T, typename... Args>
+    static void setArgs(Message & message, T number, Args... args)
+    {
+      message.args[message.nbArgs++] = {nullptr, static_cast<double>(number)};
+      setArgs(message, args...);
+    }
+
+    void drain()
+    {
+      uint64_t pos = 0;
+      int64_t lastFlushTime = 0; // [ns]
+      while (isRunning_)
+      {
+        int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        if (now - lastFlushTime > MIN_SITE_PERIOD)
+        {
+          flushSuppressed(now);
+          lastFlushTime = now;
+        }
+        Cell & cell = ring_[pos % RING_SIZE];
+        uint64_t seq = cell.seq.load(std::memory_order_acquire);
+        if (static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1) < 0)
+        {
+          std::this_thread::sleep_for(std::chrono::milliseconds(10));
+          continue;
+        }
+        print(cell.message);
+        cell.seq.store(pos + RING_SIZE, std::memory_order_release);
+        pos++;
+      }
+    }
+
+    void print(const Message & message)
+    {
+      std::ostringstream ss;
+      unsigned argIndex = 0;
+      for (const char * c = message.format; *c; c++)
+      {
+        if (c[0] == '{' && c[1] == '}')
+        {
+          if (argIndex >= message.nbArgs)
+          {
+            ss << "..."; // arguments of suppressed messages are not kept
+          }
+          else if (message.args[argIndex].string)
+          {
+            ss << message.args[argIndex++].string;
+          }
+          else
+          {
+            ss << message.args[argIndex++].number;
+          }
+          c++;
+        }
+        else
+        {
+          ss << *c;
+        }
+      }
+      if (message.nbSuppressed > 0)
+      {
+        ss << " (" << message.nbSuppressed << " similar messages suppressed)";
+      }
+      unsigned nbDropped = nbDropped_.exchange(0, std::memory_order_relaxed);
+      if (nbDropped > 0)
+      {
+        ss << " (" << nbDropped << " messages dropped)";
+      }
+      switch (message.level)
+      {
+        case Level::Info:
+          LOG_INFO(ss.str());
+          break;
+        case Level::Warning:
+          LOG_WARNING(ss.str());
+          break;
+        case Level::Error:
+          LOG_ERROR(ss.str());
+          break;
+      }
+    }
+
+  private:
+    std::array<Cell, RING_SIZE> ring_;
+    std::atomic<DeferredLogSite *> sites_{nullptr};
+    std::atomic<bool> isRunning_{true};
+    std::atomic<uint64_t> enqueuePos_{0};
+    std::atomic<unsigned> nbDropped_{0};
+    std::thread thread_;
+  };
+}
+
+/** Deferred counterparts of mc_rtc logging macros, safe to call from the
+ * control loop. Arguments are a format string with "{}" placeholders followed
+ * by numbers or static strings, e.g. CW_LOG_WARNING("{} clamped to {}", label, vMax).
+ *
+ */
+#define CW_LOG_DEFERRED(LEVEL, ...) \
+  do \
+  { \
+    static capture_walking::DeferredLogSite cwLogSite_; \
+    capture_walking::DeferredLog::instance().push(cwLogSite_, capture_walking::DeferredLog::Level::LEVEL, __VA_ARGS__); \
+  } while (0)
+
+#define CW_LOG_ERROR(...) CW_LOG_DEFERRED(Error, __VA_ARGS__)
+#define CW_LOG_INFO(...) CW_LOG_DEFERRED(Info, __VA_ARGS__)
+#define CW_LOG_WARNING(...) CW_LOG_DEFERRED(Warning, __VA_ARGS__)
@@ -0,0 +1,164 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include <mc_rtc/Configuration.h>
+#include <mc_rtc/log/Logger.h>
+#include <mc_rtc/logging.h>
+
+namespace capture_walking
+{
+  /** Log entries sorted in named groups with per-group decimation.
+   *
+   * A group with decimation N only evaluates its entries every N control
+   * cycles and repeats the last value in between. A group with decimation
+   * zero is not registered at all, so that it does not appear in the log.
+   * Groups absent from the active profile are logged at every cycle.
+   *
+   */
+  class GroupedLogger
+  {
+  public:
+    /** Wrap mc_rtc logger.
+     *
+     * \param logger Logger of the controller.
+     *
+     */
+    GroupedLogger(mc_rtc::Logger & logger)
+      : logger_(logger)
+    {
+    }
+
+    /** Add a log entry to a group.
+     *
+     * \param group Group name.
+     *
+     * \param name Name of the log entry.
+     *
+     * \param callback Function returning the logged value.
+     *
+     */
+    template <typename CallbackT>
+    void addLogEntry(const std::string & group, const std::string & name, CallbackT callback)
+    {
+      using T = typename std::decay<decltype(callback())>::type;
+      unsigned decimation = this->decimation(group);
+      if (decimation == 0)
+      {
+        return;
+      }
+      else if (decimation == 1)
+      {
+        logger_.addLogEntry(name, callback);
+        return;
+      }
+      struct Cache
+      {
+        T value;
+        bool isSet = false;
+      };
+      auto cache = std::make_shared<Cache>();
+      const unsigned & cycle = cycle_;
+      logger_.addLogEntry(name,
+        [callback, cache, decimation, &cycle]() -> T
+        {
+          if (!cache->isSet || cycle % decimation == 0)
+          {
+            cache->value = callback();
+            cache->isSet = true;
+          }
+          return cache->value;
+        });
+    }
+
+    /** Load decimation profile.
+     *
+     * \param config Configuration dictionary with a "profile" name and a
+     * "profiles" dictionary mapping profile names to group decimations.
+     *
+     */
+    void configure(const mc_rtc::Configuration & config)
+    {
+      std::string profileName = "full";
+      config("profile", profileName);
+      decimations_.clear();
+      if (!config.has("profiles") || !config("profiles").has(profileName))
+      {
+        LOG_WARNING("No \"" << profileName << "\" log profile, logging everything");
+        return;
+      }
+      mc_rtc::Configuration profile = config("profiles")(profileName);
+      for (const auto & group : profile.keys())
+      {
+        decimations_[group] = profile(group);
+      }
+      profile_ = profileName;
+      LOG_INFO("Using \"" << profile_ << "\" log profile");
+    }
+
+    /** Get decimation of a group.
+     *
+     * \param group Group name.
+     *
+     */
+    unsigned decimation(const std::string & group) const
+    {
+      auto it = decimations_.find(group);
+      return (it != decimations_.end()) ? it->second : 1;
+    }
+
+    /** Name of the active profile.
+     *
+     */
+    const std::string & profile() const
+    {
+      return profile_;
+    }
+
+    /** Advance cycle counter.
+     *
+     * \note Call once per control cycle, before the logger is run.
+     *
+     */
+    void tick()
+    {
+      cycle_++;
+    }
+
+  private:
+    mc_rtc::Logger & logger_;
+    std::map<std::string, unsigned> decimations_;
+    std::string profile_ = "full";
+    unsigned cycle_ = 0;
+  };
+}
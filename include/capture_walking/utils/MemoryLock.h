@@ -0,0 +1,70 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <malloc.h>
+#include <sys/mman.h>
+
+#include <cstddef>
+#include <cstring>
+
+namespace capture_walking
+{
+  /** Lock current and future pages of the process in RAM.
+   *
+   * The allocator is also told to neither return freed memory to the system
+   * nor serve large blocks with mmap, so that memory freed by the control
+   * loop is reused without page faults.
+   *
+   * \returns False if pages could not be locked, for instance for lack of
+   * CAP_IPC_LOCK or because RLIMIT_MEMLOCK is too low.
+   *
+   */
+  inline bool lockMemory()
+  {
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+    return (mlockall(MCL_CURRENT | MCL_FUTURE) == 0);
+  }
+
+  /** Touch the top of the calling thread's stack so that its pages are
+   * mapped before they are needed by the control loop.
+   *
+   * \param size Number of stack bytes to touch.
+   *
+   */
+  __attribute__((noinline)) inline void prefaultStack(std::size_t size)
+  {
+    constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+    volatile unsigned char chunk[CHUNK_SIZE];
+    if (size > CHUNK_SIZE)
+    {
+      prefaultStack(size - CHUNK_SIZE); // not a tail call: chunk is touched after
+    }
+    std::memset(const_cast<unsigned char*>(chunk), 0, CHUNK_SIZE);
+  }
+}
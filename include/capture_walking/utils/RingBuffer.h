@@ -0,0 +1,130 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <array>
+
+namespace capture_walking
+{
+  /** Fixed-capacity ring buffer.
+   *
+   * Pushing to a full buffer overwrites its oldest item. Storage is allocated
+   * once and for all with the buffer, so that no push or pop allocates.
+   *
+   */
+  template <typename T, unsigned N>
+  struct RingBuffer
+  {
+    /** Get item at a given offset from the front of the buffer.
+     *
+     * \param i Offset from front, zero being the oldest item.
+     *
+     */
+    const T & operator[](unsigned i) const
+    {
+      return storage_[(head_ + i) % N];
+    }
+
+    /** Maximum number of items in the buffer.
+     *
+     */
+    constexpr unsigned capacity() const
+    {
+      return N;
+    }
+
+    /** Remove all items.
+     *
+     */
+    void clear()
+    {
+      head_ = 0;
+      size_ = 0;
+    }
+
+    /** True if the buffer holds no item.
+     *
+     */
+    bool empty() const
+    {
+      return (size_ == 0);
+    }
+
+    /** Get oldest item.
+     *
+     */
+    const T & front() const
+    {
+      return storage_[head_];
+    }
+
+    /** Remove oldest item.
+     *
+     */
+    void pop_front()
+    {
+      if (size_ > 0)
+      {
+        head_ = (head_ + 1) % N;
+        size_--;
+      }
+    }
+
+    /** Append a new item, overwriting the oldest one if the buffer is full.
+     *
+     * \param item New item.
+     *
+     */
+    void push_back(const T & item)
+    {
+      unsigned tail = (head_ + size_) % N;
+      storage_[tail] = item;
+      if (size_ < N)
+      {
+        size_++;
+      }
+      else // buffer was full, tail == head_
+      {
+        head_ = (head_ + 1) % N;
+      }
+    }
+
+    /** Number of items in the buffer.
+     *
+     */
+    unsigned size() const
+    {
+      return size_;
+    }
+
+  private:
+    std::array<T, N> storage_;
+    unsigned head_ = 0;
+    unsigned size_ = 0;
+  };
+}
@@ -0,0 +1,284 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace capture_walking
+{
+  /** Single-writer ring buffer of fixed-size records in POSIX shared memory.
+   *
+   * Each slot is guarded by a sequence counter (seqlock): the writer never
+   * waits, and readers retry or skip records that were overwritten while they
+   * were being copied. Records are copied as raw bytes, so that readers in
+   * other processes only need the record definition.
+   *
+   */
+  template <typename T>
+  class SharedMemoryRing
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "shared-memory records must be trivially copyable");
+
+  public:
+    /** Identifier checked by readers before attaching.
+     *
+     */
+    static constexpr uint32_t MAGIC = 0x43574c4b; // "CWLK"
+
+    /** Segment header.
+     *
+     */
+    struct Header
+    {
+      uint32_t magic;
+      uint32_t recordSize;
+      uint32_t capacity;
+      uint32_t reserved;
+      std::atomic<uint64_t> writeCount;
+    };
+
+    /** Record slot.
+     *
+     */
+    struct Slot
+    {
+      std::atomic<uint64_t> seq; // odd while the record is being written
+      T record;
+    };
+
+    SharedMemoryRing() = default;
+    SharedMemoryRing(const SharedMemoryRing &) = delete;
+    SharedMemoryRing & operator=(const SharedMemoryRing &) = delete;
+
+    ~SharedMemoryRing()
+    {
+      close();
+    }
+
+    /** Attach to an existing segment as a reader.
+     *
+     * \param name Segment name, starting with a slash.
+     *
+     * \returns True if the segment exists and matches the record type.
+     *
+     */
+    bool attach(const std::string & name)
+    {
+      close();
+      int fd = shm_open(name.c_str(), O_RDONLY, 0);
+      if (fd < 0)
+      {
+        return false;
+      }
+      struct stat st;
+      if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(Header))
+      {
+        ::close(fd);
+        return false;
+      }
+      void * addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+      ::close(fd);
+      if (addr == MAP_FAILED)
+      {
+        return false;
+      }
+      header_ = static_cast<Header *>(addr);
+      size_ = static_cast<size_t>(st.st_size);
+      if (header_->magic != MAGIC || header_->recordSize != sizeof(T) || header_->capacity == 0 || size_ < segmentSize(header_->capacity))
+      {
+        close();
+        return false;
+      }
+      slots_ = reinterpret_cast<Slot *>(header_ + 1);
+      return true;
+    }
+
+    /** Number of slots in the ring.
+     *
+     */
+    uint32_t capacity() const
+    {
+      return (header_) ? header_->capacity : 0;
+    }
+
+    /** Unmap segment, and remove it if we created it.
+     *
+     */
+    void close()
+    {
+      if (header_)
+      {
+        munmap(header_, size_);
+      }
+      if (isWriter_)
+      {
+        shm_unlink(name_.c_str());
+      }
+      header_ = nullptr;
+      isWriter_ = false;
+      size_ = 0;
+      slots_ = nullptr;
+    }
+
+    /** Create (or recreate) segment as its single writer.
+     *
+     * \param name Segment name, starting with a slash.
+     *
+     * \param capacity Number of record slots.
+     *
+     * \returns True if the segment was successfully mapped. False if
+     * capacity is zero, as slots are indexed modulo capacity.
+     *
+     */
+    bool create(const std::string & name, uint32_t capacity)
+    {
+      close();
+      if (capacity == 0)
+      {
+        return false;
+      }
+      int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+      if (fd < 0)
+      {
+        return false;
+      }
+      size_t size = segmentSize(capacity);
+      if (ftruncate(fd, static_cast<off_t>(size)) < 0)
+      {
+        ::close(fd);
+        return false;
+      }
+      void * addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      ::close(fd);
+      if (addr == MAP_FAILED)
+      {
+        return false;
+      }
+      std::memset(addr, 0, size);
+      header_ = new (addr) Header;
+      header_->magic = MAGIC;
+      header_->recordSize = sizeof(T);
+      header_->capacity = capacity;
+      header_->writeCount.store(0, std::memory_order_relaxed);
+      slots_ = reinterpret_cast<Slot *>(header_ + 1);
+      for (uint32_t i = 0; i < capacity; i++)
+      {
+        new (&slots_[i].seq) std::atomic<uint64_t>(0);
+      }
+      isWriter_ = true;
+      name_ = name;
+      size_ = size;
+      return true;
+    }
+
+    /** True if the ring is mapped, either as reader or as writer.
+     *
+     */
+    bool isOpen() const
+    {
+      return (header_ != nullptr);
+    }
+
+    /** Append a record.
+     *
+     * \param record New record.
+     *
+     * \note Writer side only. Never blocks nor allocates.
+     *
+     */
+    void push(const T & record)
+    {
+      uint64_t count = header_->writeCount.load(std::memory_order_relaxed);
+      Slot & slot = slots_[count % header_->capacity];
+      uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+      slot.seq.store(seq + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      std::memcpy(&slot.record, &record, sizeof(T));
+      slot.seq.store(seq + 2, std::memory_order_release);
+      header_->writeCount.store(count + 1, std::memory_order_release);
+    }
+
+    /** Copy a record.
+     *
+     * \param index Index of the record since the segment was created.
+     *
+     * \param record Output record.
+     *
+     * \returns True if the record was copied consistently, false if it was
+     * not written yet or has been overwritten.
+     *
+     */
+    bool read(uint64_t index, T & record) const
+    {
+      if (index >= writeCount() || index + header_->capacity < writeCount())
+      {
+        return false;
+      }
+      const Slot & slot = slots_[index % header_->capacity];
+      uint64_t seq = slot.seq.load(std::memory_order_acquire);
+      if (seq & 1)
+      {
+        return false;
+      }
+      std::memcpy(&record, &slot.record, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return (slot.seq.load(std::memory_order_relaxed) == seq && index + header_->capacity >= writeCount());
+    }
+
+    /** Total number of records pushed since the segment was created.
+     *
+     */
+    uint64_t writeCount() const
+    {
+      return header_->writeCount.load(std::memory_order_acquire);
+    }
+
+  private:
+    static size_t segmentSize(uint32_t capacity)
+    {
+      return sizeof(Header) + capacity * sizeof(Slot);
+    }
+
+  private:
+    Header * header_ = nullptr;
+    Slot * slots_ = nullptr;
+    bool isWriter_ = false;
+    size_t size_ = 0;
+    std::string name_;
+  };
+}
@@ -0,0 +1,242 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#pragma once
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <mc_rtc/logging.h>
+
+namespace capture_walking
+{
+  /** Get CPUs a thread is allowed to run on.
+   *
+   * \param handle Thread handle.
+   *
+   */
+  inline std::vector<int> threadCpus(pthread_t handle)
+  {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(handle, sizeof(set), &set) == 0)
+    {
+      for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+      {
+        if (CPU_ISSET(cpu, &set))
+        {
+          cpus.push_back(cpu);
+        }
+      }
+    }
+    return cpus;
+  }
+
+  /** CPU affinity and scheduling policy of an auxiliary thread.
+   *
+   * A default policy leaves the thread as it was created. Applying a policy
+   * to another thread is allowed, so that threads started by utilities can
+   * be placed after the fact. Real-time schedulers require CAP_SYS_NICE or a
+   * sufficient RLIMIT_RTPRIO.
+   *
+   */
+  struct ThreadPolicy
+  {
+    /** Apply policy to a running thread.
+     *
+     * \param thread Thread to apply the policy to.
+     *
+     * \returns False if the affinity or scheduler could not be set.
+     *
+     */
+    bool apply(std::thread & thread) const
+    {
+      if (!thread.joinable())
+      {
+        return true;
+      }
+      return apply(thread.native_handle());
+    }
+
+    /** Apply policy to a running thread.
+     *
+     * \param handle Thread handle.
+     *
+     * \returns False if the affinity or scheduler could not be set.
+     *
+     */
+    bool apply(pthread_t handle) const
+    {
+      bool success = true;
+      if (!cpus.empty())
+      {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus)
+        {
+          CPU_SET(cpu, &set);
+        }
+        int error = pthread_setaffinity_np(handle, sizeof(set), &set);
+        if (error)
+        {
+          LOG_WARNING("Could not set CPU affinity of " << name << " thread: " << std::strerror(error));
+          success = false;
+        }
+      }
+      if (!scheduler.empty())
+      {
+        int policy = schedulerPolicy();
+        if (policy < 0)
+        {
+          LOG_WARNING("Unknown scheduler \"" << scheduler << "\" for " << name << " thread");
+          return false;
+        }
+        sched_param param;
+        param.sched_priority = isRealTime() ? priority : 0;
+        int error = pthread_setschedparam(handle, policy, &param);
+        if (error)
+        {
+          LOG_WARNING("Could not set scheduler of " << name << " thread: " << std::strerror(error));
+          success = false;
+        }
+      }
+      return success;
+    }
+
+    /** Describe policy in one line.
+     *
+     */
+    std::string describe() const
+    {
+      std::string description = name + ": ";
+      if (cpus.empty())
+      {
+        description += "any CPU";
+      }
+      else
+      {
+        description += "CPUs";
+        for (int cpu : cpus)
+        {
+          description += " " + std::to_string(cpu);
+        }
+      }
+      if (scheduler.empty())
+      {
+        description += ", default scheduler";
+      }
+      else
+      {
+        description += ", " + scheduler + " scheduler";
+        if (isRealTime())
+        {
+          description += " at priority " + std::to_string(priority);
+        }
+      }
+      return description;
+    }
+
+    /** Remove CPUs of the control thread from the affinity of this thread.
+     *
+     * \param controlCpus CPUs reserved for the control thread.
+     *
+     * \returns False if no CPU would be left to the thread, in which case its
+     * affinity is left unchanged.
+     *
+     */
+    bool isolateFrom(const std::vector<int> & controlCpus)
+    {
+      std::vector<int> allowed = cpus;
+      if (allowed.empty())
+      {
+        long nbCpus = sysconf(_SC_NPROCESSORS_ONLN);
+        for (int cpu = 0; cpu < nbCpus; cpu++)
+        {
+          allowed.push_back(cpu);
+        }
+      }
+      allowed.erase(std::remove_if(allowed.begin(), allowed.end(),
+        [&controlCpus](int cpu) { return std::find(controlCpus.begin(), controlCpus.end(), cpu) != controlCpus.end(); }),
+        allowed.end());
+      if (allowed.empty())
+      {
+        return false;
+      }
+      cpus = allowed;
+      return true;
+    }
+
+    /** Check whether the scheduler is a real-time one with a priority.
+     *
+     */
+    bool isRealTime() const
+    {
+      return (scheduler == "fifo" || scheduler == "rr");
+    }
+
+    /** Get POSIX scheduling policy, or -1 if the scheduler is unknown.
+     *
+     */
+    int schedulerPolicy() const
+    {
+      if (scheduler == "other")
+      {
+        return SCHED_OTHER;
+      }
+      else if (scheduler == "batch")
+      {
+        return SCHED_BATCH;
+      }
+      else if (scheduler == "idle")
+      {
+        return SCHED_IDLE;
+      }
+      else if (scheduler == "fifo")
+      {
+        return SCHED_FIFO;
+      }
+      else if (scheduler == "rr")
+      {
+        return SCHED_RR;
+      }
+      return -1;
+    }
+
+  public:
+    std::string name = "auxiliary"; /**< Thread name used in reports */
+    std::string scheduler = ""; /**< "other", "batch", "idle", "fifo" or "rr", empty to keep default */
+    std::vector<int> cpus; /**< CPUs the thread may run on, empty for any */
+    int priority = 0; /**< Static priority of "fifo" and "rr" schedulers, in [1, 99] */
+  };
+}
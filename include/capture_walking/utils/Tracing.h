@@ -0,0 +1,317 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#ifdef CAPTURE_WALKING_TRACING
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <mc_rtc/logging.h>
+
+#include <capture_walking/utils/ThreadPolicy.h>
+
+namespace capture_walking
+{
+  constexpr unsigned TRACE_FLUSH_PERIOD = 50; // [ms]
+
+  /** Completed tracing span.
+   *
+   */
+  struct TraceEvent
+  {
+    static constexpr unsigned MAX_NAME_LENGTH = 47;
+
+    char name[MAX_NAME_LENGTH + 1];
+    int64_t start; // [ns]
+    int64_t duration; // [ns]
+  };
+
+  /** Single-producer single-consumer ring of trace events.
+   *
+   * Each thread writes its spans to its own buffer, which is read by the
+   * flusher thread of the tracer.
+   *
+   */
+  struct TraceBuffer
+  {
+    static constexpr unsigned SIZE = 4096;
+
+    std::array<TraceEvent, SIZE> events;
+    std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> tail{0};
+    unsigned threadId = 0;
+  };
+
+  /** Recorder of tracing spans to a Chrome/Perfetto JSON trace file.
+   *
+   * Recording a span only copies it to a per-thread lock-free buffer. A
+   * background thread periodically flushes all buffers to the trace file.
+   * Spans recorded while a buffer is full are dropped and counted.
+   *
+   */
+  class Tracer
+  {
+  public:
+    /** Get process-wide instance.
+     *
+     */
+    static Tracer & instance()
+    {
+      static Tracer tracer;
+      return tracer;
+    }
+
+    Tracer(const Tracer &) = delete;
+    Tracer & operator=(const Tracer &) = delete;
+
+    ~Tracer()
+    {
+      close();
+    }
+
+    /** Current time on the tracing clock, in [ns].
+     *
+     */
+    static int64_t now()
+    {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /** Open trace file and start the flusher thread.
+     *
+     * \param path Path to the output JSON file.
+     *
+     */
+    void open(const std::string & path)
+    {
+      close();
+      file_ = std::fopen(path.c_str(), "w");
+      if (!file_)
+      {
+        LOG_ERROR("Could not open trace file " << path);
+        return;
+      }
+      std::fputs("[\n", file_);
+      isFirstEvent_ = true;
+      origin_ = now();
+      isRunning_ = true;
+      thread_ = std::thread(&Tracer::flushLoop, this);
+      threadPolicy_.apply(thread_);
+      isOpen_.store(true, std::memory_order_release);
+      LOG_INFO("Recording tracing spans to " << path);
+    }
+
+    /** Flush remaining spans and close trace file.
+     *
+     */
+    void close()
+    {
+      if (!isOpen_.exchange(false))
+      {
+        return;
+      }
+      isRunning_ = false;
+      if (thread_.joinable())
+      {
+        thread_.join();
+      }
+      flush();
+      std::fputs("\n]\n", file_);
+      std::fclose(file_);
+      file_ = nullptr;
+      unsigned nbDropped = nbDropped_.exchange(0);
+      if (nbDropped > 0)
+      {
+        LOG_WARNING("Dropped " << nbDropped << " tracing spans");
+      }
+    }
+
+    /** Set CPU affinity and scheduling of the flusher thread.
+     *
+     * \param policy Thread policy, applied now if the thread is running.
+     *
+     */
+    void threadPolicy(const ThreadPolicy & policy)
+    {
+      threadPolicy_ = policy;
+      threadPolicy_.apply(thread_);
+    }
+
+    /** Check whether spans are being recorded.
+     *
+     */
+    bool isOpen() const
+    {
+      return isOpen_.load(std::memory_order_relaxed);
+    }
+
+    /** Record a completed span.
+     *
+     * \param name Span name, truncated to TraceEvent::MAX_NAME_LENGTH.
+     *
+     * \param start Start time on the tracing clock, in [ns].
+     *
+     * \param end End time on the tracing clock, in [ns].
+     *
+     */
+    void record(const char * name, int64_t start, int64_t end)
+    {
+      TraceBuffer & buffer = threadBuffer();
+      uint64_t head = buffer.head.load(std::memory_order_relaxed);
+      if (head - buffer.tail.load(std::memory_order_acquire) >= TraceBuffer::SIZE)
+      {
+        nbDropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      TraceEvent & event = buffer.events[head % TraceBuffer::SIZE];
+      std::strncpy(event.name, name, TraceEvent::MAX_NAME_LENGTH);
+      event.name[TraceEvent::MAX_NAME_LENGTH] = '\0';
+      event.start = start;
+      event.duration = end - start;
+      buffer.head.store(head + 1, std::memory_order_release);
+    }
+
+  private:
+    Tracer() = default;
+
+    TraceBuffer & threadBuffer()
+    {
+      thread_local TraceBuffer * buffer = nullptr;
+      if (!buffer)
+      {
+        std::lock_guard<std::mutex> lock(buffersMutex_);
+        buffers_.emplace_back(new TraceBuffer);
+        buffer = buffers_.back().get();
+        buffer->threadId = static_cast<unsigned>(buffers_.size());
+      }
+      return *buffer;
+    }
+
+    void flushLoop()
+    {
+      while (isRunning_)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(TRACE_FLUSH_PERIOD));
+        flush();
+      }
+    }
+
+    void flush()
+    {
+      std::lock_guard<std::mutex> lock(buffersMutex_);
+      for (auto & buffer : buffers_)
+      {
+        uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        for (; tail != head; tail++)
+        {
+          const TraceEvent & event = buffer->events[tail % TraceBuffer::SIZE];
+          std::fprintf(file_, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+            isFirstEvent_ ? "" : ",\n", event.name, buffer->threadId,
+            static_cast<double>(event.start - origin_) / 1000., static_cast<double>(event.duration) / 1000.);
+          isFirstEvent_ = false;
+        }
+        buffer->tail.store(tail, std::memory_order_release);
+      }
+      std::fflush(file_);
+    }
+
+  private:
+    FILE * file_ = nullptr;
+    ThreadPolicy threadPolicy_;
+    bool isFirstEvent_ = true;
+    int64_t origin_ = 0; // [ns]
+    std::atomic<bool> isOpen_{false};
+    std::atomic<bool> isRunning_{false};
+    std::atomic<unsigned> nbDropped_{0};
+    std::mutex buffersMutex_;
+    std::thread thread_;
+    std::vector<std::unique_ptr<TraceBuffer>> buffers_;
+  };
+
+  /** Tracing span covering the enclosing scope.
+   *
+   */
+  class TraceSpan
+  {
+  public:
+    /** Start span.
+     *
+     * \param name Span name, copied so that it may be a temporary.
+     *
+     */
+    TraceSpan(const char * name)
+      : start_(-1)
+    {
+      if (Tracer::instance().isOpen())
+      {
+        std::strncpy(name_, name, TraceEvent::MAX_NAME_LENGTH);
+        name_[TraceEvent::MAX_NAME_LENGTH] = '\0';
+        start_ = Tracer::now();
+      }
+    }
+
+    ~TraceSpan()
+    {
+      if (start_ >= 0 && Tracer::instance().isOpen())
+      {
+        Tracer::instance().record(name_, start_, Tracer::now());
+      }
+    }
+
+  private:
+    char name_[TraceEvent::MAX_NAME_LENGTH + 1];
+    int64_t start_; // [ns]
+  };
+}
+
+#define CW_TRACE_CONCAT_(a, b) a##b
+#define CW_TRACE_CONCAT(a, b) CW_TRACE_CONCAT_(a, b)
+
+/** Record a tracing span covering the enclosing scope.
+ *
+ * Compiled out unless the CAPTURE_WALKING_TRACING option is enabled.
+ *
+ */
+#define CW_TRACE_SPAN(name) capture_walking::TraceSpan CW_TRACE_CONCAT(cwTraceSpan_, __LINE__)(name)
+
+#else
+
+#define CW_TRACE_SPAN(name) do {} while (0)
+
+#endif
@@ -0,0 +1,106 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+namespace capture_walking
+{
+  /** Single-producer single-consumer triple buffer.
+   *
+   * The producer fills its private write buffer then publishes it by swapping
+   * it with the shared middle buffer. The consumer swaps its private read
+   * buffer with the middle one whenever a fresh value is available. Neither
+   * side ever blocks, and each side only touches one buffer at a time.
+   *
+   */
+  template <typename T>
+  class TripleBuffer
+  {
+  public:
+    /** Publish the write buffer and switch to a recycled one.
+     *
+     * \note Producer side only.
+     *
+     */
+    void publish()
+    {
+      unsigned prev = middle_.exchange(writeIndex_ | FRESH_BIT, std::memory_order_acq_rel);
+      writeIndex_ = prev & INDEX_MASK;
+    }
+
+    /** Most recent value acquired by the consumer.
+     *
+     * \note Consumer side only.
+     *
+     */
+    const T & read() const
+    {
+      return buffers_[readIndex_];
+    }
+
+    /** Acquire the last published value, if any.
+     *
+     * \returns True if a fresh value was acquired.
+     *
+     * \note Consumer side only.
+     *
+     */
+    bool update()
+    {
+      if (!(middle_.load(std::memory_order_relaxed) & FRESH_BIT))
+      {
+        return false;
+      }
+      unsigned prev = middle_.exchange(readIndex_, std::memory_order_acq_rel);
+      readIndex_ = prev & INDEX_MASK;
+      return true;
+    }
+
+    /** Buffer to fill before the next call to publish().
+     *
+     * \note Producer side only.
+     *
+     */
+    T & write()
+    {
+      return buffers_[writeIndex_];
+    }
+
+  private:
+    static constexpr unsigned FRESH_BIT = 4;
+    static constexpr unsigned INDEX_MASK = 3;
+
+  private:
+    std::array<T, 3> buffers_;
+    std::atomic<unsigned> middle_{1};
+    unsigned readIndex_ = 2;
+    unsigned writeIndex_ = 0;
+  };
+}
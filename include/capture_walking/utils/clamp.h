@@ -27,7 +27,7 @@
 
 #pragma once
 
-#include <mc_rtc/logging.h>
+#include <capture_walking/utils/DeferredLog.h>
 
 /** Clamp a value in a given interval.
  *
@@ -86,17 +86,19 @@ inline void clampInPlace(double & v, double vMin, double vMax)
  *
  * \param label Name of clamped value.
  *
+ * \param site Deferred log site of the caller, see CW_CLAMP.
+ *
  */
-inline double clamp(double v, double vMin, double vMax, const char * label)
+inline double clamp(double v, double vMin, double vMax, const char * label, capture_walking::DeferredLogSite & site)
 {
   if (v > vMax)
   {
-    LOG_WARNING(label << " clamped to " << vMax);
+    capture_walking::DeferredLog::instance().push(site, capture_walking::DeferredLog::Level::Warning, "{} clamped to {}", label, vMax);
     return vMax;
   }
   else if (v < vMin)
   {
-    LOG_WARNING(label << " clamped to " << vMin);
+    capture_walking::DeferredLog::instance().push(site, capture_walking::DeferredLog::Level::Warning, "{} clamped to {}", label, vMin);
     return vMin;
   }
   else
@@ -115,17 +117,31 @@ inline double clamp(double v, double vMin, double vMax, const char * label)
  *
  * \param label Name of clamped value.
  *
+ * \param site Deferred log site of the caller, see CW_CLAMP_IN_PLACE.
+ *
  */
-inline void clampInPlace(double & v, double vMin, double vMax, const char * label)
+inline void clampInPlace(double & v, double vMin, double vMax, const char * label, capture_walking::DeferredLogSite & site)
 {
-  if (v > vMax)
-  {
-    LOG_WARNING(label << " clamped to " << vMax);
-    v = vMax;
-  }
-  else if (v < vMin)
-  {
-    LOG_WARNING(label << " clamped to " << vMin);
-    v = vMin;
-  }
+  v = clamp(v, vMin, vMax, label, site);
 }
+
+/** Clamp a value with a warning rate-limited at the call site, so that
+ * warnings from different clamped values do not suppress each other.
+ *
+ */
+#define CW_CLAMP(v, vMin, vMax, label) \
+  ([&]() \
+  { \
+    static capture_walking::DeferredLogSite cwClampSite_; \
+    return clamp(v, vMin, vMax, label, cwClampSite_); \
+  }())
+
+/** In-place counterpart of CW_CLAMP.
+ *
+ */
+#define CW_CLAMP_IN_PLACE(v, vMin, vMax, label) \
+  ([&]() \
+  { \
+    static capture_walking::DeferredLogSite cwClampSite_; \
+    clampInPlace(v, vMin, vMax, label, cwClampSite_); \
+  }())
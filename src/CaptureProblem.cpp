@@ -30,7 +30,9 @@
 #include <capture_walking/CaptureProblem.h>
 #include <capture_walking/CaptureSolution.h>
 #include <capture_walking/defs.h>
+#include <capture_walking/utils/DeferredLog.h>
 #include <capture_walking/utils/Interval.h>
+#include <capture_walking/utils/Tracing.h>
 
 namespace capture_walking
 {
@@ -124,6 +126,7 @@ namespace capture_walking
 
   bool CaptureProblem::solveWithFixedAlpha(double alpha)
   {
+    CW_TRACE_SPAN("CaptureProblem::solveWithFixedAlpha");
     bool solutionFound;
     updateProblem_(alpha);
     if (isObviouslyInfeasible_())
@@ -196,7 +199,7 @@ namespace capture_walking
     double rightTime = solveStepTime(alpha + alphaStep);
     if (leftTime < 0. && rightTime < 0.)
     {
-      LOG_ERROR("Cannot compute step-time derivative at alpha=" << alpha << ", alphaStep=" << alphaStep);
+      CW_LOG_ERROR("Cannot compute step-time derivative at alpha={}, alphaStep={}", alpha, alphaStep);
       return 0.; // next search direction will be arbitrary
     }
     else if (leftTime < 0. && rightTime > 0.)
@@ -215,6 +218,7 @@ namespace capture_walking
 
   bool CaptureProblem::solve()
   {
+    CW_TRACE_SPAN("CaptureProblem::solve");
     constexpr double SEARCH_STEP_TIME_PREC = 0.01;
     constexpr double SEARCH_MAX_ALPHA_PREC = 1e-3;
 
@@ -400,26 +404,26 @@ namespace capture_walking
       case cps::SolverStatus::Converge:
         if (logSuccess)
         {
-          LOG_INFO("CaptureProblem: CPS converged");
+          CW_LOG_INFO("CaptureProblem: CPS converged");
         }
         break;
       case cps::SolverStatus::MaxIteration:
-        LOG_WARNING("CaptureProblem: CPS reached maximum number of iterations");
+        CW_LOG_WARNING("CaptureProblem: CPS reached maximum number of iterations");
         break;
       case cps::SolverStatus::LineSearchFailed:
-        LOG_WARNING("CaptureProblem: SQP line search failed");
+        CW_LOG_WARNING("CaptureProblem: SQP line search failed");
         break;
       case cps::SolverStatus::NoLinearlyFeasiblePoint:
-        LOG_ERROR("CaptureProblem: problem not linearly feasible");
+        CW_LOG_ERROR("CaptureProblem: problem not linearly feasible");
         break;
       case cps::SolverStatus::NumericallyEquivalentIterates:
         if (logSuccess)
         {
-          LOG_INFO("CaptureProblem: CPS returned with numerically equivalent iterates");
+          CW_LOG_INFO("CaptureProblem: CPS returned with numerically equivalent iterates");
         }
         break;
       case cps::SolverStatus::Fail:
-        LOG_ERROR("CaptureProblem: CPS returned with fail status");
+        CW_LOG_ERROR("CaptureProblem: CPS returned with fail status");
         break;
       default:
         break;
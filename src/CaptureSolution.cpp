@@ -27,15 +27,53 @@
 
 #include <capture_walking/CaptureSolution.h>
 #include <capture_walking/CaptureProblem.h>
+#include <capture_walking/utils/DeferredLog.h>
 
 namespace capture_walking
 {
+  namespace
+  {
+    /** Find index j such that values[j] <= x < values[j + 1].
+     *
+     * \param values Sorted vector of values.
+     *
+     * \param x Value to look up.
+     *
+     * \param cursor Index found by the previous lookup, updated in place.
+     *
+     * Lookups are amortized O(1) when successive values of x do not decrease,
+     * which is the case during playback. Going backward falls back to a
+     * binary search.
+     *
+     */
+    unsigned seek(const std::vector<double> & values, double x, unsigned & cursor)
+    {
+      if (cursor >= values.size() || x < values[cursor])
+      {
+        auto it = std::upper_bound(values.begin(), values.end(), x);
+        long j = std::distance(values.begin(), it) - 1;
+        cursor = (j > 0) ? static_cast<unsigned>(j) : 0;
+        return cursor;
+      }
+      while (cursor + 1 < values.size() && values[cursor + 1] <= x)
+      {
+        cursor++;
+      }
+      return cursor;
+    }
+  }
+
   CaptureSolution::CaptureSolution(unsigned nbSteps)
     : lambda(nbSteps + 1),
       phi(nbSteps + 1),
       svec(nbSteps + 1),
       switchTimes(nbSteps),
-      nbSteps(nbSteps)
+      nbSteps(nbSteps),
+      segmentOmega_(nbSteps),
+      segmentSqrtLambda_(nbSteps),
+      sqrtLambda_(nbSteps + 1),
+      sqrtPhi_(nbSteps + 1),
+      tFromSNum_(nbSteps)
   {
     double ds = 1. / nbSteps;
     for (unsigned i = 0; i <= nbSteps; i++)
@@ -56,6 +94,7 @@ namespace capture_walking
       lambda[j] = (phi[j + 1] - phi[j]) / pb.delta()[j];
     }
     lambda[nbSteps] = lambda[nbSteps - 1];
+    computeSegmentConstants();
 
     alpha = alpha_;
     com_f = pb.targetCoM();
@@ -78,25 +117,42 @@ namespace capture_walking
     cost_ = cost;
   }
 
+  void CaptureSolution::computeSegmentConstants()
+  {
+    for (unsigned j = 0; j <= nbSteps; j++)
+    {
+      sqrtLambda_[j] = std::sqrt(lambda[j]);
+      sqrtPhi_[j] = std::sqrt(phi[j]);
+    }
+    for (unsigned j = 0; j < nbSteps; j++)
+    {
+      tFromSNum_[j] = sqrtPhi_[j + 1] + svec[j + 1] * sqrtLambda_[j];
+      segmentOmega_[j] = sqrtPhi_[nbSteps - j] / svec[nbSteps - j];
+      segmentSqrtLambda_[j] = sqrtLambda_[nbSteps - j - 1];
+    }
+    phiCursor_ = 0;
+    sCursor_ = 0;
+    timeCursor_ = 0;
+  }
+
   void CaptureSolution::computeSwitchTimes()
   {
     switchTimes[0] = 0.;
     double curSwitchTime = 0.;
     for (unsigned j = nbSteps - 1; j > 0; j--)
     {
-      double sqrt_lambda_j = std::sqrt(lambda[j]);
-      double num = std::sqrt(phi[j + 1]) + sqrt_lambda_j * svec[j + 1];
-      double denom = std::sqrt(phi[j]) + sqrt_lambda_j * svec[j];
-      curSwitchTime += std::log(num / denom) / sqrt_lambda_j;
+      double denom = sqrtPhi_[j] + sqrtLambda_[j] * svec[j];
+      curSwitchTime += std::log(tFromSNum_[j] / denom) / sqrtLambda_[j];
       switchTimes[nbSteps - j] = curSwitchTime;
     }
+    timeCursor_ = 0;
   }
 
   void CaptureSolution::computeStepTime()
   {
     if (alpha < 0)
     {
-      LOG_WARNING("Solution is unset (alpha < 0), no step time to compute");
+      CW_LOG_WARNING("Solution is unset (alpha < 0), no step time to compute");
       stepTime_ = -1.;
       return;
     }
@@ -113,14 +169,13 @@ namespace capture_walking
   {
     if (phiValue < -1e-5 || phiValue > phi[nbSteps])
     {
-      LOG_ERROR("Value phi = " << phiValue << " out of range [0, " << phi[nbSteps] << "]");
+      CW_LOG_ERROR("Value phi = {} out of range [0, {}]", phiValue, phi[nbSteps]);
       return -1.;
     }
-    auto it = std::upper_bound(phi.begin(), phi.end(), phiValue);
-    long j = std::distance(phi.begin(), it) - 1;
-    assert (j >= 0 && phi[j] <= phiValue && (j == nbSteps || phiValue < phi[j + 1]));
-    unsigned j_ = static_cast<unsigned>(j); // avoid conversion warning
-    double s_sq = (svec[j_] * svec[j_]) + (phiValue - phi[j_]) / lambda[j];
+    unsigned j = seek(phi, phiValue, phiCursor_);
+    assert (phi[j] <= phiValue || j == 0);
+    assert (j == nbSteps || phiValue < phi[j + 1]);
+    double s_sq = (svec[j] * svec[j]) + (phiValue - phi[j]) / lambda[j];
     return std::sqrt(s_sq);
   }
 
@@ -128,26 +183,23 @@ namespace capture_walking
   {
     if (std::isnan(s) || s < -1e-5 || s > 1.)
     {
-      LOG_ERROR("Value s = " << s << " out of range [0, 1]");
+      CW_LOG_ERROR("Value s = {} out of range [0, 1]", s);
       return -1.;
     }
-    auto it = std::upper_bound(svec.begin(), svec.end(), s);
-    long j = std::distance(svec.begin(), it) - 1;
-    assert (j >= 0 && svec[j] <= s && j < nbSteps && s < svec[j + 1]);
-    unsigned j_ = static_cast<unsigned>(j); // avoid conversion warning
-    double s_next = svec[j_ + 1];
-    double t_next = switchTimes[nbSteps - (j_ + 1)];
-    double sqrt_lambda_j = std::sqrt(lambda[j]);
-    double num = std::sqrt(phi[j_ + 1]) + s_next * sqrt_lambda_j;
-    double denom = std::sqrt(phi[j_ + 1] - lambda[j] * (std::pow(s_next, 2) - std::pow(s, 2))) + s * sqrt_lambda_j;
-    return t_next + std::log(num / denom) / std::sqrt(lambda[j]);
+    unsigned j = seek(svec, s, sCursor_);
+    assert (svec[j] <= s || j == 0);
+    assert (j < nbSteps && s < svec[j + 1]);
+    double s_next = svec[j + 1];
+    double t_next = switchTimes[nbSteps - (j + 1)];
+    double denom = std::sqrt(phi[j + 1] - lambda[j] * (s_next * s_next - s * s)) + s * sqrtLambda_[j];
+    return t_next + std::log(tFromSNum_[j] / denom) / sqrtLambda_[j];
   }
 
   std::vector<Eigen::Vector3d> CaptureSolution::computeCoMTrajectory()
   {
     if (alpha < 0.)
     {
-      LOG_WARNING("Solution is unset (alpha < 0), no CoM trajectory");
+      CW_LOG_WARNING("Solution is unset (alpha < 0), no CoM trajectory");
       return {};
     }
 
@@ -183,24 +235,58 @@ namespace capture_walking
 
   double CaptureSolution::omega(double t)
   {
-    auto it = std::upper_bound(switchTimes.begin(), switchTimes.end(), t);
-    long j = std::distance(switchTimes.begin(), it) - 1;
-    assert(j >= 0 && switchTimes[j] <= t && (j == nbSteps || t < switchTimes[j + 1]));
-    return omega(t, static_cast<unsigned>(j));
+    unsigned j = seek(switchTimes, t, timeCursor_);
+    assert(switchTimes[j] <= t && (j == nbSteps || t < switchTimes[j + 1]));
+    return omega(t, j);
   }
 
   double CaptureSolution::omega(double t, unsigned j)
   {
     // ASSUMPTION: switchTimes[j] <= t < switchTimes[j + 1]
-    double lambda_j = lambda[nbSteps - j - 1];
-    double omega_j = std::sqrt(phi[nbSteps - j]) / svec[nbSteps - j];
-    double sqrt_lambda_j = std::sqrt(lambda_j);
+    double omega_j = segmentOmega_[j];
+    double sqrt_lambda_j = segmentSqrtLambda_[j];
     double x = sqrt_lambda_j / (t - switchTimes[j + 1]);
     double z = sqrt_lambda_j / omega_j;
     return sqrt_lambda_j * (1. - z * std::tanh(x)) / (z - std::tanh(x));
   }
 
+  void CaptureSolution::sample(const Pendulum & state, double dt)
+  {
+    clearSamples(dt);
+    if (alpha < 0.)
+    {
+      return;
+    }
+    if (stepTime_ < 0.)
+    {
+      computeStepTime();
+    }
+    bool initPlaybackIsOver = playbackIsOver_;
+    double initPlaybackTime = playbackTime_;
+    unsigned initPlaybackStep = playbackStep_;
+    double horizon = std::max(stepTime_, switchTimes[nbSteps - 1]) - playbackTime_;
+    unsigned nbSamples = std::min(PREVIEW_BUFFER_SIZE, static_cast<unsigned>(std::max(horizon, 0.) / dt));
+    Pendulum sampledState = state;
+    for (unsigned i = 0; i < nbSamples; i++)
+    {
+      integrateSolution(sampledState, dt);
+      pushSample(sampledState);
+    }
+    playbackIsOver_ = initPlaybackIsOver;
+    playbackTime_ = initPlaybackTime;
+    playbackStep_ = initPlaybackStep;
+  }
+
   void CaptureSolution::integrate(Pendulum & state, double dt)
+  {
+    if (playSample(state, dt))
+    {
+      return;
+    }
+    integrateSolution(state, dt);
+  }
+
+  void CaptureSolution::integrateSolution(Pendulum & state, double dt)
   {
     if (stepTime_ < 0.)
     {
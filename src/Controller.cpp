@@ -25,9 +25,24 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <limits>
+
 #include <mc_rbdyn/rpy_utils.h>
 
 #include <capture_walking/Controller.h>
+#include <capture_walking/State.h>
+#include <capture_walking/utils/DeferredLog.h>
+#include <capture_walking/utils/MemoryLock.h>
+#include <capture_walking/utils/Tracing.h>
 #include <capture_walking/utils/clamp.h>
 
 namespace capture_walking
@@ -35,12 +50,20 @@ namespace capture_walking
   Controller::Controller(std::shared_ptr<mc_rbdyn::RobotModule> robotModule, double dt, const mc_rtc::Configuration & config)
     : mc_control::fsm::Controller(robotModule, dt, config),
       halfSitPose(controlRobot().mbc().q),
+      logGroups_(logger()),
       comVelFilter_(dt, /* cutoff period = */ 0.01),
       pendulumObserver_(dt),
       stabilizer_(controlRobot(), pendulum_, dt, getPostureTask(robot().name())),
       floatingBaseObserver_(controlRobot())
   {
     postureTask = getPostureTask(robot().name());
+    DeferredLog::instance(); // start log thread before the control loop does
+
+    // Timestamp of the files decoding this run's log, same format as mc_rtc
+    char timestamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%d-%H-%M-%S", std::localtime(&now));
+    logTimestamp_ = timestamp;
 
     // Set half-sitting pose for posture task
     const auto & halfSit = robotModule->stance();
@@ -57,76 +80,183 @@ namespace capture_walking
     plans_ = config("plans");
     hmpcConfig_ = config("hmpc");
     sole = config("sole");
+    soleHash_ = configurationHash(config("sole").dump());
+    for (const auto & name : plans_.keys())
+    {
+      planHashes_[name] = configurationHash(plans_(name).dump());
+    }
     std::string initialPlan = plans_.keys()[0];
     config("initial_plan", initialPlan);
+    if (config.has("log"))
+    {
+      logGroups_.configure(config("log"));
+      std::string directory;
+      config("log")("segment_labels_directory", directory);
+      if (!directory.empty())
+      {
+        segmentLabelsPath_ = directory + "/capture_walking-segment-labels-" + logTimestamp_ + ".csv";
+      }
+    }
     if (config.has("stabilizer"))
     {
       stabilizer_.configure(config("stabilizer"));
     }
+    if (config.has("presolve"))
+    {
+      presolver.configure(config("presolve"));
+    }
+    if (config.has("preview_trigger"))
+    {
+      previewTrigger_ = config("preview_trigger");
+    }
+    if (config.has("telemetry"))
+    {
+      configureTelemetry(config("telemetry"));
+    }
+    if (config.has("footstep_stream"))
+    {
+      configureFootstepStream(config("footstep_stream"));
+    }
+    if (config.has("allocation_audit"))
+    {
+      configureAllocationAudit(config("allocation_audit"));
+    }
+    if (config.has("plan_library"))
+    {
+      configurePlanLibrary(config("plan_library"));
+    }
+    if (config.has("plan_validation"))
+    {
+      configurePlanValidation(config("plan_validation"));
+    }
+    if (config.has("warmup"))
+    {
+      configureWarmUp(config("warmup"));
+    }
+    if (warmUpEnabled_ && lockMemory_)
+    {
+      isMemoryLocked_ = lockMemory(); // before the control loop, as it can take a while
+      if (!isMemoryLocked_)
+      {
+        LOG_WARNING("Could not lock process memory: " << std::strerror(errno));
+      }
+    }
+#ifdef CAPTURE_WALKING_TRACING
+    std::string tracePath = "/tmp/capture_walking-trace.json";
+    if (config.has("tracing"))
+    {
+      config("tracing")("file", tracePath);
+    }
+    Tracer::instance().open(tracePath);
+#endif
+    if (config.has("threads"))
+    {
+      configureThreads(config("threads"));
+    }
 
+    cycleBudget.budget(timeStep);
+    segmentLabels_ = plans_.keys();
+    writeSegmentLabels();
     loadFootstepPlan(initialPlan);
     updateRobotMass(robot().mass());
     stabilizer_.reset(robots());
     stabilizer_.wrenchFaceMatrix(sole);
 
-    logger().addLogEntry("controlRobot_LeftFoot", [this]() { return controlRobot().surfacePose("LeftFoot"); });
-    logger().addLogEntry("controlRobot_LeftFootCenter", [this]() { return controlRobot().surfacePose("LeftFootCenter"); });
-    logger().addLogEntry("controlRobot_RightFoot", [this]() { return controlRobot().surfacePose("RightFoot"); });
-    logger().addLogEntry("controlRobot_RightFootCenter", [this]() { return controlRobot().surfacePose("RightFootCenter"); });
-    logger().addLogEntry("controlRobot_com", [this]() { return controlCom_; });
-    logger().addLogEntry("controlRobot_comd", [this]() { return controlComd_; });
-    logger().addLogEntry("controlRobot_comd_norm", [this]() { return controlComd_.norm(); });
-    logger().addLogEntry("controlRobot_dcm", [this]() -> Eigen::Vector3d { return controlCom_ + controlComd_ / pendulum_.omega(); });
-    logger().addLogEntry("controlRobot_posW", [this]() { return controlRobot().posW(); });
-    logger().addLogEntry("cps_desired_step_time", [this]() { return cps.desiredStepTime(); });
-    logger().addLogEntry("cps_init_contact", [this]() { return cps.initContact().p(); });
-    logger().addLogEntry("cps_solution_step_time", [this]() { return cps.solution().stepTime(); });
-    logger().addLogEntry("cps_target_cop", [this]() { return cps.targetCoP(); });
-    logger().addLogEntry("error_com", [this]() -> Eigen::Vector3d { return controlCom_ - realCom_; });
-    logger().addLogEntry("error_comd", [this]() -> Eigen::Vector3d { return controlComd_ - realComd_; });
-    logger().addLogEntry("error_dcm", [this]() -> Eigen::Vector3d { return (controlCom_ - realCom_) + (controlComd_ - realComd_) / pendulum_.omega(); });
-    logger().addLogEntry("error_zmp", [this]() -> Eigen::Vector3d { return stabilizer_.distribZMP() - pendulumObserver_.zmp(); });
-    logger().addLogEntry("estimator_com", [this]() { return pendulumObserver_.com(); });
-    logger().addLogEntry("estimator_comd",[this]() { return pendulumObserver_.comd(); });
-    logger().addLogEntry("estimator_dcm", [this]() { return pendulumObserver_.dcm(); });
-    logger().addLogEntry("estimator_zmp", [this]() { return pendulumObserver_.zmp(); });
-    logger().addLogEntry("hmpc_failures", [this]() { return nbHMPCFailures_; });
-    logger().addLogEntry("hmpc_pbstep", [this]() { return (preview) ? preview->playbackStep() : 0; });
-    logger().addLogEntry("hmpc_pbtime", [this]() { return (preview) ? preview->playbackTime() : -0.42; });
-    logger().addLogEntry("hmpc_updates", [this]() { return nbHMPCUpdates_; });
-    logger().addLogEntry("hmpc_weights_jerk", [this]() { return hmpc.jerkWeight; });
-    logger().addLogEntry("hmpc_weights_vel", [this]() { return hmpc.velWeights; });
-    logger().addLogEntry("hmpc_weights_zmp", [this]() { return hmpc.zmpWeight; });
-    logger().addLogEntry("left_foot_ratio", [this]() { return leftFootRatio_; });
-    logger().addLogEntry("left_foot_ratio_measured", [this]() { return measuredLeftFootRatio(); });
-    logger().addLogEntry("observers_kin_posW", [this]() { return floatingBaseObserver_.posW(); });
-    logger().addLogEntry("pendulum_com", [this]() { return pendulum_.com(); });
-    logger().addLogEntry("pendulum_comd", [this]() { return pendulum_.comd(); });
-    logger().addLogEntry("pendulum_comdd", [this]() { return pendulum_.comdd(); });
-    logger().addLogEntry("pendulum_dcm", [this]() { return pendulum_.dcm(); });
-    logger().addLogEntry("pendulum_omega", [this]() { return pendulum_.omega(); });
-    logger().addLogEntry("pendulum_zmp", [this]() { return pendulum_.zmp(); });
-    logger().addLogEntry("plan_com_height", [this]() { return plan.comHeight(); });
-    logger().addLogEntry("plan_double_support_duration", [this]() { return plan.doubleSupportDuration(); });
-    logger().addLogEntry("plan_final_dsp_duration", [this]() { return plan.finalDSPDuration(); });
-    logger().addLogEntry("plan_init_dsp_duration", [this]() { return plan.initDSPDuration(); });
-    logger().addLogEntry("plan_landing_pitch", [this]() { return plan.landingPitch(); });
-    logger().addLogEntry("plan_landing_ratio", [this]() { return plan.landingRatio(); });
-    logger().addLogEntry("plan_ref_vel", [this]() { return plan.supportContact().refVel; });
-    logger().addLogEntry("plan_single_support_duration", [this]() { return plan.singleSupportDuration(); });
-    logger().addLogEntry("plan_swing_height", [this]() { return plan.swingHeight(); });
-    logger().addLogEntry("plan_takeoff_offset", [this]() { return plan.takeoffOffset(); });
-    logger().addLogEntry("plan_takeoff_pitch", [this]() { return plan.takeoffPitch(); });
-    logger().addLogEntry("plan_takeoff_ratio", [this]() { return plan.takeoffRatio(); });
-    logger().addLogEntry("realRobot_LeftFoot", [this]() { return realRobot().surfacePose("LeftFoot"); });
-    logger().addLogEntry("realRobot_LeftFootCenter", [this]() { return realRobot().surfacePose("LeftFootCenter"); });
-    logger().addLogEntry("realRobot_RightFoot", [this]() { return realRobot().surfacePose("RightFoot"); });
-    logger().addLogEntry("realRobot_RightFootCenter", [this]() { return realRobot().surfacePose("RightFootCenter"); });
-    logger().addLogEntry("realRobot_com", [this]() { return realCom_; });
-    logger().addLogEntry("realRobot_comd", [this]() { return realComd_; });
-    logger().addLogEntry("realRobot_dcm", [this]() -> Eigen::Vector3d { return realCom_ + realComd_ / pendulum_.omega(); });
-    logger().addLogEntry("realRobot_posW", [this]() { return realRobot().posW(); });
-    stabilizer_.addLogEntries(logger());
+    if (allocationAudit.isAvailable())
+    {
+      logGroups_.addLogEntry("budget", "alloc_cycle_bytes", [this]() { return static_cast<unsigned>(allocationAudit.cycle().nbBytes); });
+      logGroups_.addLogEntry("budget", "alloc_cycle_count", [this]() { return static_cast<unsigned>(allocationAudit.cycle().nbAllocations); });
+      logGroups_.addLogEntry("budget", "alloc_state_count", [this]() { return static_cast<unsigned>(allocationAudit.stateAllocations()); });
+    }
+    logGroups_.addLogEntry("budget", "cycle_fsm", [this]() { return cycleBudget.duration(CycleSection::FSM); });
+    logGroups_.addLogEntry("budget", "cycle_observers", [this]() { return cycleBudget.duration(CycleSection::Observers); });
+    logGroups_.addLogEntry("budget", "cycle_overruns", [this]() { return static_cast<unsigned>(cycleBudget.nbOverruns()); });
+    logGroups_.addLogEntry("budget", "cycle_preview", [this]() { return cycleBudget.duration(CycleSection::Preview); });
+    logGroups_.addLogEntry("budget", "cycle_stabilizer", [this]() { return cycleBudget.duration(CycleSection::Stabilizer); });
+    logGroups_.addLogEntry("budget", "cycle_total", [this]() { return cycleBudget.duration(CycleSection::Total); });
+    logGroups_.addLogEntry("budget", "cycle_transition", [this]() { return cycleBudget.isTransition(); });
+    logGroups_.addLogEntry("time", "ctl_time", [this]() { return ctlTime_; });
+    logGroups_.addLogEntry("time", "rem_phase_time", [this]() { return (activeState_) ? activeState_->remPhaseTime() : 0.; });
+    logGroups_.addLogEntry("time", "segment_id", [this]() { return segmentId_; });
+    logGroups_.addLogEntry("time", "segment_label", [this]() { return segmentLabel_; });
+    logGroups_.addLogEntry("time", "segment_time", [this]() { return (segmentId_ > 0) ? ctlTime_ - segmentStartTime_ : 0.; });
+    logGroups_.addLogEntry("time", "walking_phase", [this]() { return static_cast<double>(walkingPhase_); });
+    logGroups_.addLogEntry("controlRobot", "controlRobot_LeftFoot", [this]() { return controlRobot().surfacePose("LeftFoot"); });
+    logGroups_.addLogEntry("controlRobot", "controlRobot_LeftFootCenter", [this]() { return controlRobot().surfacePose("LeftFootCenter"); });
+    logGroups_.addLogEntry("controlRobot", "controlRobot_RightFoot", [this]() { return controlRobot().surfacePose("RightFoot"); });
+    logGroups_.addLogEntry("controlRobot", "controlRobot_RightFootCenter", [this]() { return controlRobot().surfacePose("RightFootCenter"); });
+    logGroups_.addLogEntry("controlRobot", "controlRobot_com", [this]() { return controlCom_; });
+    logGroups_.addLogEntry("controlRobot", "controlRobot_comd", [this]() { return controlComd_; });
+    logGroups_.addLogEntry("controlRobot", "controlRobot_comd_norm", [this]() { return controlComd_.norm(); });
+    logGroups_.addLogEntry("controlRobot", "controlRobot_dcm", [this]() -> Eigen::Vector3d { return controlCom_ + controlComd_ / pendulum_.omega(); });
+    logGroups_.addLogEntry("controlRobot", "controlRobot_posW", [this]() { return controlRobot().posW(); });
+    logGroups_.addLogEntry("wpg", "cps_desired_step_time", [this]() { return cps.desiredStepTime(); });
+    logGroups_.addLogEntry("wpg", "cps_init_contact", [this]() { return cps.initContact().p(); });
+    logGroups_.addLogEntry("wpg", "cps_solution_step_time", [this]() { return cps.solution().stepTime(); });
+    logGroups_.addLogEntry("wpg", "cps_target_cop", [this]() { return cps.targetCoP(); });
+    logGroups_.addLogEntry("errors", "error_com", [this]() -> Eigen::Vector3d { return controlCom_ - realCom_; });
+    logGroups_.addLogEntry("errors", "error_comd", [this]() -> Eigen::Vector3d { return controlComd_ - realComd_; });
+    logGroups_.addLogEntry("errors", "error_dcm", [this]() -> Eigen::Vector3d { return (controlCom_ - realCom_) + (controlComd_ - realComd_) / pendulum_.omega(); });
+    logGroups_.addLogEntry("errors", "error_zmp", [this]() -> Eigen::Vector3d { return stabilizer_.distribZMP() - pendulumObserver_.zmp(); });
+    logGroups_.addLogEntry("estimator", "estimator_com", [this]() { return pendulumObserver_.com(); });
+    logGroups_.addLogEntry("estimator", "estimator_comd",[this]() { return pendulumObserver_.comd(); });
+    logGroups_.addLogEntry("estimator", "estimator_dcm", [this]() { return pendulumObserver_.dcm(); });
+    logGroups_.addLogEntry("estimator", "estimator_zmp", [this]() { return pendulumObserver_.zmp(); });
+    logGroups_.addLogEntry("wpg", "fallback_previews", [this]() { return nbFallbackPreviews_; });
+    logGroups_.addLogEntry("wpg", "hmpc_failures", [this]() { return nbHMPCFailures_; });
+    logGroups_.addLogEntry("wpg", "hmpc_pbstep", [this]() { return (preview) ? preview->playbackStep() : 0; });
+    logGroups_.addLogEntry("wpg", "hmpc_pbtime", [this]() { return (preview) ? preview->playbackTime() : -0.42; });
+    logGroups_.addLogEntry("wpg", "hmpc_updates", [this]() { return nbHMPCUpdates_; });
+    logGroups_.addLogEntry("stabilizer", "left_foot_ratio", [this]() { return leftFootRatio_; });
+    logGroups_.addLogEntry("stabilizer", "left_foot_ratio_measured", [this]() { return measuredLeftFootRatio(); });
+    logGroups_.addLogEntry("estimator", "observers_kin_posW", [this]() { return floatingBaseObserver_.posW(); });
+    logGroups_.addLogEntry("pendulum", "pendulum_com", [this]() { return pendulum_.com(); });
+    logGroups_.addLogEntry("pendulum", "pendulum_comd", [this]() { return pendulum_.comd(); });
+    logGroups_.addLogEntry("pendulum", "pendulum_comdd", [this]() { return pendulum_.comdd(); });
+    logGroups_.addLogEntry("pendulum", "pendulum_dcm", [this]() { return pendulum_.dcm(); });
+    logGroups_.addLogEntry("pendulum", "pendulum_omega", [this]() { return pendulum_.omega(); });
+    logGroups_.addLogEntry("pendulum", "pendulum_zmp", [this]() { return pendulum_.zmp(); });
+    logGroups_.addLogEntry("wpg", "preview_trigger", [this]() { return static_cast<int>(lastPreviewTrigger_); });
+    logGroups_.addLogEntry("wpg", "nominal_previews", [this]() { return nbNominalPreviews_; });
+    logGroups_.addLogEntry("wpg", "presolved_previews", [this]() { return nbPresolvedPreviews_; });
+    logGroups_.addLogEntry("wpg", "streamed_footsteps", [this]() { return footstepStream_.nbReceived(); });
+    logGroups_.addLogEntry("wpg", "support_xmax", [this]() { return std::max(supportContact().xmax(), secondSupportContact().xmax()); });
+    logGroups_.addLogEntry("wpg", "support_xmin", [this]() { return std::min(supportContact().xmin(), secondSupportContact().xmin()); });
+    logGroups_.addLogEntry("wpg", "support_ymax", [this]() { return std::max(supportContact().ymax(), secondSupportContact().ymax()); });
+    logGroups_.addLogEntry("wpg", "support_ymin", [this]() { return std::min(supportContact().ymin(), secondSupportContact().ymin()); });
+    logGroups_.addLogEntry("wpg", "support_zmax", [this]() { return std::max(supportContact().zmax(), secondSupportContact().zmax()); });
+    logGroups_.addLogEntry("wpg", "support_zmin", [this]() { return std::min(supportContact().zmin(), secondSupportContact().zmin()); });
+    swingFoot.addLogEntries(logGroups_);
+    logGroups_.addLogEntry("realRobot", "realRobot_LeftFoot", [this]() { return realRobot().surfacePose("LeftFoot"); });
+    logGroups_.addLogEntry("realRobot", "realRobot_LeftFootCenter", [this]() { return realRobot().surfacePose("LeftFootCenter"); });
+    logGroups_.addLogEntry("realRobot", "realRobot_RightFoot", [this]() { return realRobot().surfacePose("RightFoot"); });
+    logGroups_.addLogEntry("realRobot", "realRobot_RightFootCenter", [this]() { return realRobot().surfacePose("RightFootCenter"); });
+    logGroups_.addLogEntry("realRobot", "realRobot_com", [this]() { return realCom_; });
+    logGroups_.addLogEntry("realRobot", "realRobot_comd", [this]() { return realComd_; });
+    logGroups_.addLogEntry("realRobot", "realRobot_dcm", [this]() -> Eigen::Vector3d { return realCom_ + realComd_ / pendulum_.omega(); });
+    logGroups_.addLogEntry("realRobot", "realRobot_posW", [this]() { return realRobot().posW(); });
+    stabilizer_.addLogEntries(logGroups_);
+
+    changeLog_.addEntry("hmpc_weights_jerk", [this]() { return hmpc.jerkWeight; });
+    changeLog_.addEntry("hmpc_weights_vel", [this]() { return hmpc.velWeights; });
+    changeLog_.addEntry("hmpc_weights_zmp", [this]() { return hmpc.zmpWeight; });
+    changeLog_.addEntry("plan_com_height", [this]() { return plan.comHeight(); });
+    changeLog_.addEntry("plan_double_support_duration", [this]() { return plan.doubleSupportDuration(); });
+    changeLog_.addEntry("plan_final_dsp_duration", [this]() { return plan.finalDSPDuration(); });
+    changeLog_.addEntry("plan_init_dsp_duration", [this]() { return plan.initDSPDuration(); });
+    changeLog_.addEntry("plan_landing_pitch", [this]() { return plan.landingPitch(); });
+    changeLog_.addEntry("plan_landing_ratio", [this]() { return plan.landingRatio(); });
+    changeLog_.addEntry("plan_ref_vel", [this]() { return plan.supportContact().refVel; });
+    changeLog_.addEntry("plan_single_support_duration", [this]() { return plan.singleSupportDuration(); });
+    changeLog_.addEntry("plan_swing_height", [this]() { return plan.swingHeight(); });
+    changeLog_.addEntry("plan_takeoff_offset", [this]() { return plan.takeoffOffset(); });
+    changeLog_.addEntry("plan_takeoff_pitch", [this]() { return plan.takeoffPitch(); });
+    changeLog_.addEntry("plan_takeoff_ratio", [this]() { return plan.takeoffRatio(); });
+    stabilizer_.addChangeLogEntries(changeLog_);
+    if (config.has("changelog"))
+    {
+      configureChangeLog(config("changelog"));
+    }
 
     if (gui_)
     {
@@ -135,14 +265,14 @@ namespace capture_walking
         {"Sensors"},
         ArrayInput(
           "IMU", {"R [deg]", "P [deg]", "Y [deg]"},
-          [this]() -> Eigen::Vector3d { return mc_rbdyn::rpyFromMat(realRobot().bodySensor().orientation().toRotationMatrix()) * 180. / M_PI; },
+          [this]() -> Eigen::Vector3d { return mc_rbdyn::rpyFromMat(sensorFrame_.imuOrientation) * 180. / M_PI; },
           [](const Eigen::Vector3d &) {}),
         Label(
           "Left foot pressure [N]",
-          [this]() { return realRobot().forceSensor("LeftFootForceSensor").force()[2]; }),
+          [this]() { return sensorFrame_.leftFoot.pressure; }),
         Label(
           "Right foot pressure [N]",
-          [this]() { return realRobot().forceSensor("RightFootForceSensor").force()[2]; }));
+          [this]() { return sensorFrame_.rightFoot.pressure; }));
       gui_->addElement(
         {"Walking", "Controller"},
         Button("# EMERGENCY STOP",
@@ -154,7 +284,90 @@ namespace capture_walking
         Button("Reset",
           [this]() { this->resume("Initial"); }),
         Label("Mass [kg]",
-          [this]() { return std::round(robotMass_ * 100.) / 100.; }));
+          [this]() { return std::round(robotMass_ * 100.) / 100.; }),
+        Label("Cycle p50/p99/p99.9/max [ms]",
+          [this]()
+          {
+            const LatencyHistogram & histogram = cycleBudget.histogram(CycleSection::Total);
+            char buffer[64];
+            std::snprintf(buffer, sizeof(buffer), "%.3f / %.3f / %.3f / %.3f",
+              1000. * histogram.percentile(0.5), 1000. * histogram.percentile(0.99),
+              1000. * histogram.percentile(0.999), 1000. * histogram.max());
+            return std::string(buffer);
+          }),
+        Label("Overruns",
+          [this]()
+          {
+            std::string overruns = std::to_string(cycleBudget.nbOverruns());
+            for (const auto & stats : cycleBudget.stateStats())
+            {
+              if (stats.nbOverruns > 0)
+              {
+                overruns += " " + stats.name + ":" + std::to_string(stats.nbOverruns);
+              }
+            }
+            return overruns;
+          }),
+        Label("Transition cycle p99/max [ms]",
+          [this]()
+          {
+            const LatencyHistogram & histogram = cycleBudget.transitionHistogram();
+            char buffer[64];
+            std::snprintf(buffer, sizeof(buffer), "%.3f / %.3f",
+              1000. * histogram.percentile(0.99), 1000. * histogram.max());
+            return std::string(buffer);
+          }),
+        Label("Steady cycle p99/max [ms]",
+          [this]()
+          {
+            const LatencyHistogram & histogram = cycleBudget.steadyHistogram();
+            char buffer[64];
+            std::snprintf(buffer, sizeof(buffer), "%.3f / %.3f",
+              1000. * histogram.percentile(0.99), 1000. * histogram.max());
+            return std::string(buffer);
+          }),
+        Button("Reset cycle statistics",
+          [this]() { cycleBudget.reset(); }),
+        Button("Pause walking",
+          [this]()
+          {
+            if (walkingPhase_ != WalkingPhase::SingleSupport && walkingPhase_ != WalkingPhase::DoubleSupport)
+            {
+              LOG_WARNING("Robot is not walking");
+              return;
+            }
+            pauseWalking = true;
+          }),
+        Label("Infeasible steps",
+          [this]() -> std::string
+          {
+            if (!planValidator_.enabled())
+            {
+              return "not validated";
+            }
+            if (!planValidator_.isDone())
+            {
+              return "validating...";
+            }
+            return std::to_string(planValidator_.nbInfeasibleSteps()) + " / " + std::to_string(planValidator_.nbSteps());
+          }),
+        Label("Warm-up",
+          [this]() { return warmUpReport_; }));
+      if (allocationAudit.isAvailable())
+      {
+        gui_->addElement(
+          {"Walking", "Controller"},
+          Label("Allocating cycles",
+            [this]()
+            {
+              std::string report;
+              for (const auto & stats : allocationAudit.stateStats())
+              {
+                report += stats.name + ":" + std::to_string(stats.nbAllocatingCycles) + "/" + std::to_string(stats.nbCycles) + " ";
+              }
+              return report;
+            }));
+      }
       gui_->addElement(
         {"Walking", "WPG"},
         ComboInput(
@@ -186,6 +399,29 @@ namespace capture_walking
             "Preview update period [s]",
             [this]() { return previewUpdatePeriod; },
             [this](double period) { previewUpdatePeriod = clamp(period, 0., 1.); }),
+        ComboInput(
+          "Preview updates",
+          {"periodic", "event"},
+          [this]() { return previewTrigger_.eventTriggered ? "event" : "periodic"; },
+          [this](const std::string & mode) { previewTrigger_.eventTriggered = (mode == "event"); }),
+        ArrayInput(
+          "Preview events", {"DCM error [m]", "ZMP margin [m]", "Contact drift [m]", "Max period [s]"},
+          [this]()
+          {
+            Eigen::VectorXd thresholds(4);
+            thresholds[0] = previewTrigger_.maxDCMError;
+            thresholds[1] = previewTrigger_.minZMPMargin;
+            thresholds[2] = previewTrigger_.maxContactDrift;
+            thresholds[3] = previewTrigger_.maxPeriod;
+            return thresholds;
+          },
+          [this](const Eigen::VectorXd & thresholds)
+          {
+            previewTrigger_.maxDCMError = thresholds[0];
+            previewTrigger_.minZMPMargin = thresholds[1];
+            previewTrigger_.maxContactDrift = thresholds[2];
+            previewTrigger_.maxPeriod = thresholds[3];
+          }),
         ArrayInput(
           "Capture CoP offset", {"x", "y"},
           [this]() { return cps.ankleToTargetCoP; },
@@ -272,6 +508,7 @@ namespace capture_walking
     if(!isSpinning_)
     {
       spinThread_ = std::thread(std::bind(&Controller::spinner, this));
+      spinnerPolicy_.apply(spinThread_);
       isSpinning_ = true;
     }
 
@@ -291,17 +528,22 @@ namespace capture_walking
     plan.reset();
     postureTask->posture(halfSitPose);
     stabilizer_.reset(robots());
-    stabilizer_.updateState(initCom, Eigen::Vector3d::Zero(), sva::ForceVecd{Eigen::Vector6d::Zero()});
+    stabilizer_.updateState(initCom, Eigen::Vector3d::Zero(), SensorFrame());
 
     controlCom_ = initCom;
     controlComd_ = Eigen::Vector3d::Zero();
     leftFootRatioJumped_ = false;
     leftFootRatio_ = 0.5;
+    nbFallbackPreviews_ = 0;
     nbHMPCFailures_ = 0;
     nbHMPCUpdates_ = 0;
+    nbNominalPreviews_ = 0;
+    nbPresolvedPreviews_ = 0;
     pauseWalking = false;
+    presolver.cancel();
     realCom_ = initCom; // realRobot() may not be initialized yet
     realComd_ = Eigen::Vector3d::Zero();
+    waitForFootsteps = false;
 
     stopLogSegment();
   }
@@ -311,10 +553,10 @@ namespace capture_walking
     double maxRatioVar = 1.5 * timeStep / plan.doubleSupportDuration();
     if (std::abs(ratio - leftFootRatio_) > maxRatioVar)
     {
-      LOG_WARNING("Left foot ratio jumped from " << leftFootRatio_ << " to " << ratio);
+      CW_LOG_WARNING("Left foot ratio jumped from {} to {}", leftFootRatio_, ratio);
       leftFootRatioJumped_ = true;
     }
-    leftFootRatio_ = clamp(ratio, 0., 1., "leftFootRatio");
+    leftFootRatio_ = CW_CLAMP(ratio, 0., 1., "leftFootRatio");
   }
 
   bool Controller::run()
@@ -328,21 +570,26 @@ namespace capture_walking
       return mc_control::fsm::Controller::run();
     }
 
+    allocationAudit.startCycle();
+    cycleBudget.startCycle();
+    auto observersStart = CycleBudget::clock::now();
     controlCom_ = controlRobot().com();
     controlComd_ = controlRobot().comVelocity();
     ctlTime_ += timeStep;
+    logGroups_.tick();
+    lastPreviewTrigger_ = PreviewUpdateReason::None;
+    if (plan.isStreaming() && footstepStream_.isOpen())
+    {
+      footstepStream_.receive(plan, sole);
+    }
 
     // check contact state
-    const auto & lfSensor = realRobot().forceSensor("LeftFootForceSensor");
-    const auto & rfSensor = realRobot().forceSensor("RightFootForceSensor");
-    constexpr double CONTACT_THRESHOLD = 30.; // [N]
-    double leftFootPressure = lfSensor.force().z();
-    double rightFootPressure = rfSensor.force().z();
-    if (leftFootPressure < CONTACT_THRESHOLD && rightFootPressure < CONTACT_THRESHOLD)
+    sensorFrame_.read(realRobot());
+    if (sensorFrame_.isInTheAir())
     {
       if (!isInTheAir_)
       {
-        LOG_WARNING("Robot is in the air");
+        CW_LOG_WARNING("Robot is in the air");
         isInTheAir_ = true;
       }
     }
@@ -350,14 +597,14 @@ namespace capture_walking
     {
       if (isInTheAir_)
       {
-        LOG_INFO("Robot is on the ground again");
+        CW_LOG_INFO("Robot is on the ground again");
         isInTheAir_ = false;
       }
     }
 
     // update kinematic observer
     floatingBaseObserver_.leftFootRatio(leftFootRatio_);
-    floatingBaseObserver_.run(realRobot());
+    floatingBaseObserver_.run(realRobot(), sensorFrame_);
 
     // update realCom_
     floatingBaseObserver_.update(realRobot());
@@ -375,92 +622,666 @@ namespace capture_walking
     }
     realComd_ = comVelFilter_.vel();
 
-    sva::ForceVecd contactWrench = measuredContactWrench();
-    pendulumObserver_.update(/* comGuess = */ realCom_, contactWrench, supportContact());
-    stabilizer_.updateState(realCom_, realComd_, contactWrench, leftFootRatio_);
+    sensorFrame_.updateWorldWrenches(realRobot());
+    pendulumObserver_.update(/* comGuess = */ realCom_, sensorFrame_, supportContact());
+    stabilizer_.updateState(realCom_, realComd_, sensorFrame_, leftFootRatio_);
 
-    bool ret = mc_control::fsm::Controller::run();
+    cycleBudget.addToSection(CycleSection::Observers, observersStart);
+
+    bool ret;
+    {
+      CycleBudget::ScopedSection section(cycleBudget, CycleSection::FSM);
+      ret = mc_control::fsm::Controller::run();
+    }
     if (mc_control::fsm::Controller::running())
     {
       postureTask->posture(halfSitPose); // reset posture in case the FSM updated it
     }
+    publishSnapshot();
+    if (telemetry_.isOpen())
+    {
+      writeTelemetry();
+    }
+    changeLog_.update(ctlTime_);
+    cycleBudget.endCycle();
+    allocationAudit.endCycle(lastPreviewTrigger_ != PreviewUpdateReason::None);
+    if (allocationAudit.strict() && allocationAudit.isSteadyStateViolation())
+    {
+      CW_LOG_ERROR("{} heap allocations ({} bytes) in steady-state walking cycle",
+        allocationAudit.cycle().nbAllocations, allocationAudit.cycle().nbBytes);
+      return false;
+    }
     return ret;
   }
 
-  sva::ForceVecd Controller::measuredContactWrench()
+  void Controller::configureAllocationAudit(const mc_rtc::Configuration & config)
   {
-    sva::ForceVecd netWrench{Eigen::Vector6d::Zero()};
-    for (std::string sensorName : {"LeftFootForceSensor", "RightFootForceSensor"})
+    bool strict = false;
+    std::vector<std::string> steadyStates;
+    config("strict", strict);
+    if (config.has("steady_states"))
+    {
+      steadyStates = config("steady_states");
+      allocationAudit.steadyStates(steadyStates);
+    }
+    if (!allocationAudit.isAvailable())
+    {
+      if (strict)
+      {
+        LOG_WARNING("Allocation hook library not preloaded, cannot audit allocations");
+      }
+      return;
+    }
+    allocationAudit.strict(strict);
+    LOG_INFO("Auditing heap allocations in the control loop" << (strict ? " (strict mode)" : ""));
+  }
+
+  void Controller::configureChangeLog(const mc_rtc::Configuration & config)
+  {
+    bool enabled = false;
+    config("enabled", enabled);
+    if (!enabled)
+    {
+      return;
+    }
+    std::string directory = "/tmp";
+    double period = changeLog_.period();
+    config("directory", directory);
+    config("period", period);
+    changeLog_.period(period);
+
+    std::string path = directory + "/capture_walking-changes-" + logTimestamp_ + ".csv";
+    if (changeLog_.open(path))
+    {
+      LOG_INFO("Parameter changes written to " << path);
+    }
+    else
+    {
+      LOG_ERROR("Could not open change log " << path);
+    }
+  }
+
+  void Controller::configureFootstepStream(const mc_rtc::Configuration & config)
+  {
+    bool enabled = false;
+    std::string path = FOOTSTEP_STREAM_SOCKET;
+    config("enabled", enabled);
+    config("socket", path);
+    if (enabled)
+    {
+      footstepStream_.open(path);
+    }
+  }
+
+  void Controller::configurePlanLibrary(const mc_rtc::Configuration & config)
+  {
+    bool enabled = false;
+    std::string path = "";
+    config("enabled", enabled);
+    config("file", path);
+    if (enabled && !path.empty())
+    {
+      planLibrary_.open(path);
+    }
+  }
+
+  void Controller::configurePlanValidation(const mc_rtc::Configuration & config)
+  {
+    planValidator_.configure(config);
+  }
+
+  void Controller::configureTelemetry(const mc_rtc::Configuration & config)
+  {
+    bool enabled = false;
+    config("enabled", enabled);
+    if (!enabled)
+    {
+      return;
+    }
+    std::string segment = TELEMETRY_SEGMENT;
+    unsigned capacity = 4000;
+    config("segment", segment);
+    config("capacity", capacity);
+    if (capacity == 0)
+    {
+      LOG_ERROR("Telemetry capacity must be positive, telemetry disabled");
+      return;
+    }
+    if (telemetry_.create(segment, capacity))
+    {
+      LOG_INFO("Telemetry written to shared-memory segment " << segment);
+    }
+    else
+    {
+      LOG_ERROR("Could not create telemetry segment " << segment);
+    }
+  }
+
+  void Controller::configureThreads(const mc_rtc::Configuration & config)
+  {
+    bool isolate = false;
+    std::vector<int> controlCpus;
+    config("isolate_from_control", isolate);
+    config("control_cpus", controlCpus);
+    if (isolate && controlCpus.empty())
+    {
+      controlCpus = threadCpus(pthread_self());
+      if (static_cast<long>(controlCpus.size()) >= sysconf(_SC_NPROCESSORS_ONLN))
+      {
+        LOG_WARNING("Control thread is not pinned, set \"control_cpus\" to isolate auxiliary threads from it");
+        isolate = false;
+      }
+    }
+
+    auto readPolicy = [&](const std::string & name)
+    {
+      ThreadPolicy policy;
+      policy.name = name;
+      if (config.has(name))
+      {
+        config(name)("cpus", policy.cpus);
+        config(name)("priority", policy.priority);
+        config(name)("scheduler", policy.scheduler);
+      }
+      if (isolate && !policy.isolateFrom(controlCpus))
+      {
+        LOG_WARNING("No CPU left for " << name << " thread outside of control CPUs");
+      }
+      return policy;
+    };
+
+    ThreadPolicy deferredLogPolicy = readPolicy("deferred_log");
+    ThreadPolicy planValidatorPolicy = readPolicy("plan_validator");
+    ThreadPolicy presolverPolicy = readPolicy("presolver");
+    spinnerPolicy_ = readPolicy("spinner");
+    DeferredLog::instance().threadPolicy(deferredLogPolicy);
+    planValidator_.threadPolicy(planValidatorPolicy);
+    presolver.threadPolicy(presolverPolicy);
+    spinnerPolicy_.apply(spinThread_);
+    std::string report = "Thread policies";
+    if (isolate)
     {
-      const auto & sensor = realRobot().forceSensor(sensorName);
-      if (sensor.force()[2] > 1.)
+      report += " (isolated from control CPUs";
+      for (int cpu : controlCpus)
       {
-        netWrench += sensor.worldWrench(realRobot());
+        report += " " + std::to_string(cpu);
       }
+      report += ")";
     }
-    return netWrench;
+    report += ":\n  " + deferredLogPolicy.describe();
+    report += "\n  " + planValidatorPolicy.describe();
+    report += "\n  " + presolverPolicy.describe();
+    report += "\n  " + spinnerPolicy_.describe();
+#ifdef CAPTURE_WALKING_TRACING
+    ThreadPolicy tracerPolicy = readPolicy("tracer");
+    Tracer::instance().threadPolicy(tracerPolicy);
+    report += "\n  " + tracerPolicy.describe();
+#endif
+    LOG_INFO(report);
+  }
+
+  void Controller::configureWarmUp(const mc_rtc::Configuration & config)
+  {
+    config("enabled", warmUpEnabled_);
+    config("lock_memory", lockMemory_);
+    config("solves", nbWarmUpSolves_);
+    config("stack_prefault", stackPrefaultSize_);
+  }
+
+  void Controller::writeTelemetry()
+  {
+    auto copy3 = [](double * dest, const Eigen::Vector3d & v)
+    {
+      dest[0] = v.x();
+      dest[1] = v.y();
+      dest[2] = v.z();
+    };
+    auto copyFoot = [&copy3](double * cop, double * force, const SensorFrame::Foot & foot)
+    {
+      cop[0] = foot.cop.x();
+      cop[1] = foot.cop.y();
+      copy3(force, foot.surfaceWrench.force());
+    };
+
+    TelemetryRecord record;
+    record.time = ctlTime_;
+    copy3(record.pendulumCom, pendulum_.com());
+    copy3(record.pendulumComd, pendulum_.comd());
+    copy3(record.pendulumZMP, pendulum_.zmp());
+    record.pendulumOmega = pendulum_.omega();
+    copy3(record.observerCom, pendulumObserver_.com());
+    copy3(record.observerComd, pendulumObserver_.comd());
+    copy3(record.observerZMP, pendulumObserver_.zmp());
+    copy3(record.realCom, realCom_);
+    copy3(record.realComd, realComd_);
+    copy3(record.distribZMP, stabilizer_.distribZMP());
+    record.leftFootRatio = leftFootRatio_;
+    copyFoot(record.leftFootCoP, record.leftFootForce, sensorFrame_.leftFoot);
+    copyFoot(record.rightFootCoP, record.rightFootForce, sensorFrame_.rightFoot);
+    record.previewPlaybackStep = (preview) ? static_cast<double>(preview->playbackStep()) : -1.;
+    record.previewPlaybackTime = (preview) ? preview->playbackTime() : 0.;
+    copy3(record.supportContact, supportContact().p());
+    copy3(record.targetContact, targetContact().p());
+    telemetry_.push(record);
   }
 
   void Controller::loadFootstepPlan(std::string name)
   {
-    plan = plans_(name);
+    std::vector<Contact> streamedContacts;
+    if (plan.isStreaming() && plan.name == name)
+    {
+      streamedContacts = plan.streamedContacts(); // already consumed from the socket
+    }
+    int index = planLibrary_.find(name);
+    if (index >= 0 && !planLibrary_.isUpToDate(static_cast<unsigned>(index), planHashes_[name], soleHash_))
+    {
+      LOG_WARNING("Precompiled plan \"" << name << "\" is outdated, reading it from configuration (recompile the plan library)");
+      index = -1;
+    }
+    hmpc.configure(hmpcConfig_);
+    if (index >= 0)
+    {
+      const PlanRecord & record = planLibrary_.plan(static_cast<unsigned>(index));
+      planLibrary_.instantiate(static_cast<unsigned>(index), plan);
+      if (!std::isnan(record.hmpcJerkWeight))
+      {
+        hmpc.jerkWeight = record.hmpcJerkWeight;
+      }
+      if (!std::isnan(record.hmpcVelWeights[0]))
+      {
+        hmpc.velWeights = {record.hmpcVelWeights[0], record.hmpcVelWeights[1]};
+      }
+      if (!std::isnan(record.hmpcZMPWeight))
+      {
+        hmpc.zmpWeight = record.hmpcZMPWeight;
+      }
+    }
+    else
+    {
+      plan = plans_(name);
+      if (plans_(name).has("hmpc"))
+      {
+        hmpc.configure(plans_(name)("hmpc"));
+      }
+    }
     plan.complete(sole);
     plan.name = name;
+    if (plan.isStreaming())
+    {
+      for (const Contact & contact : streamedContacts)
+      {
+        plan.appendContact(contact);
+      }
+    }
     plan.reset();
-    hmpc.configure(hmpcConfig_);
-    if (plans_(name).has("hmpc"))
+    if (planValidator_.enabled())
     {
-      hmpc.configure(plans_(name)("hmpc"));
+      PresolveRequest defaults = makePresolveRequest(supportContact(), targetContact(), nextContact(), plan.doubleSupportDuration(), false);
+      planValidator_.start(plan, defaults);
     }
+    changeLog_.poll(ctlTime_);
     LOG_INFO("Loaded footstep plan \"" << name << "\"");
   }
 
   void Controller::startLogSegment(const std::string & label)
   {
-    if (segmentName_.length() > 0)
+    auto it = std::find(segmentLabels_.begin(), segmentLabels_.end(), label);
+    if (it == segmentLabels_.end())
     {
-      stopLogSegment();
+      segmentLabels_.push_back(label);
+      writeSegmentLabels();
+      it = segmentLabels_.end() - 1;
     }
-    segmentName_ = "t_" + std::to_string(++nbLogSegments_).erase(0, 1) + "_" + label;
-    logger().addLogEntry(segmentName_, [this]() { return ctlTime_; });
+    segmentId_ = ++nbLogSegments_;
+    segmentLabel_ = static_cast<int>(it - segmentLabels_.begin());
+    segmentStartTime_ = ctlTime_;
   }
 
   void Controller::stopLogSegment()
   {
-    logger().removeLogEntry(segmentName_);
-    segmentName_ = "";
+    segmentId_ = 0;
+    segmentLabel_ = -1;
+  }
+
+  void Controller::startWarmUp()
+  {
+    CW_TRACE_SPAN("Controller::startWarmUp");
+    if (!warmUpEnabled_ || nbWarmUpSolves_ == 0)
+    {
+      return;
+    }
+    prefaultStack(stackPrefaultSize_);
+    firstWarmUpTimes_ = {};
+    lastWarmUpTimes_ = {};
+    isWarmingUp_ = true;
+    warmUpIndex_ = 0;
+    warmUpReport_ = "running...";
+  }
+
+  void Controller::runWarmUp()
+  {
+    using clock = std::chrono::steady_clock;
+    CW_TRACE_SPAN("Controller::runWarmUp");
+    if (!isWarmingUp_)
+    {
+      return;
+    }
+
+    // representative inputs: first step from the current standing posture
+    const Contact & support = supportContact();
+    const Contact & target = targetContact();
+    const Contact & next = nextContact();
+    unsigned solveIndex = warmUpIndex_ / 2;
+    std::array<double, 2> & times = (solveIndex == 0) ? firstWarmUpTimes_ : lastWarmUpTimes_;
+    auto startTime = clock::now();
+    if (warmUpIndex_ % 2 == 0)
+    {
+      cps.contacts(support, target);
+      cps.stepTime(plan.initDSPDuration());
+      cps.initState(pendulum_);
+      cps.targetHeight(plan.comHeight());
+      if (cps.solve())
+      {
+        CaptureSolution solution(cps.solution());
+        solution.sample(pendulum_, timeStep);
+      }
+      times[0] = 1000. * std::chrono::duration<double>(clock::now() - startTime).count();
+    }
+    else
+    {
+      hmpc.contacts(support, target, next);
+      hmpc.phaseDurations(0., plan.initDSPDuration(), singleSupportDuration());
+      hmpc.initState(pendulum_);
+      hmpc.comHeight(plan.comHeight());
+      if (hmpc.solve())
+      {
+        HorizontalMPCSolution solution(hmpc.solution());
+        solution.sample(pendulum_, timeStep, support, plan.comHeight());
+      }
+      times[1] = 1000. * std::chrono::duration<double>(clock::now() - startTime).count();
+    }
+    if (++warmUpIndex_ < 2 * nbWarmUpSolves_)
+    {
+      return; // one solve per cycle
+    }
+
+    if (nbWarmUpSolves_ == 1)
+    {
+      lastWarmUpTimes_ = firstWarmUpTimes_;
+    }
+    char buffer[128];
+    std::snprintf(buffer, sizeof(buffer),
+      "CPS %.2f -> %.2f ms, HMPC %.2f -> %.2f ms, memory %s",
+      firstWarmUpTimes_[0], lastWarmUpTimes_[0], firstWarmUpTimes_[1], lastWarmUpTimes_[1],
+      isMemoryLocked_ ? "locked" : "not locked");
+    warmUpReport_ = buffer;
+    isWarmingUp_ = false;
+    LOG_INFO("Warm-up (first -> last of " << nbWarmUpSolves_ << " solves): " << warmUpReport_);
+  }
+
+  void Controller::activeState(State * state)
+  {
+    activeState_ = state;
+    if (state)
+    {
+      walkingPhase_ = state->phase();
+    }
+  }
+
+  bool Controller::isFirstStart(const std::string & name)
+  {
+    if (std::find(startedStates_.begin(), startedStates_.end(), name) != startedStates_.end())
+    {
+      return false;
+    }
+    startedStates_.push_back(name);
+    return true;
+  }
+
+  void Controller::addStabilizerTasks()
+  {
+    if (!hasStabilizerTasks_)
+    {
+      stabilizer_.addTasks(solver());
+      hasStabilizerTasks_ = true;
+    }
+  }
+
+  void Controller::removeStabilizerTasks()
+  {
+    if (hasStabilizerTasks_)
+    {
+      stabilizer_.removeTasks(solver());
+      hasStabilizerTasks_ = false;
+    }
+  }
+
+  const Contact & Controller::secondSupportContact()
+  {
+    switch (walkingPhase_)
+    {
+      case WalkingPhase::DoubleSupport:
+        return prevContact();
+      case WalkingPhase::SingleSupport:
+        return supportContact();
+      case WalkingPhase::Initial:
+      case WalkingPhase::Standing:
+        break;
+    }
+    return targetContact();
+  }
+
+  void Controller::writeSegmentLabels()
+  {
+    if (segmentLabelsPath_.empty())
+    {
+      return;
+    }
+    std::ofstream file(segmentLabelsPath_);
+    if (!file)
+    {
+      LOG_ERROR("Could not write segment labels to " << segmentLabelsPath_);
+      return;
+    }
+    file << "index,label\n";
+    for (unsigned i = 0; i < segmentLabels_.size(); i++)
+    {
+      file << i << "," << segmentLabels_[i] << "\n";
+    }
+  }
+
+  bool Controller::previewUpdateRequired(double timeSinceLastUpdate)
+  {
+    double dcmError = 0.;
+    double zmpMargin = std::numeric_limits<double>::infinity();
+    double contactDrift = 0.;
+    if (previewTrigger_.eventTriggered)
+    {
+      const Contact * contacts[2] = {nullptr, nullptr};
+      unsigned nbContacts = 0;
+      switch (stabilizer_.contactState())
+      {
+        case ContactState::DoubleSupport:
+          contacts[nbContacts++] = &stabilizer_.leftFootContact;
+          contacts[nbContacts++] = &stabilizer_.rightFootContact;
+          break;
+        case ContactState::LeftFoot:
+          contacts[nbContacts++] = &stabilizer_.leftFootContact;
+          break;
+        case ContactState::RightFoot:
+          contacts[nbContacts++] = &stabilizer_.rightFootContact;
+          break;
+        case ContactState::Flying:
+          break;
+      }
+      for (unsigned i = 0; i < nbContacts; i++)
+      {
+        const Contact & contact = *contacts[i];
+        Eigen::Vector3d measuredPos = realRobot().surfacePose(contact.surfaceName()).translation();
+        contactDrift = std::max(contactDrift, (measuredPos - contact.p()).norm());
+      }
+      if (nbContacts == 2) // ZMP lies between the feet in double support
+      {
+        zmpMargin = doubleSupportMargin(*contacts[0], *contacts[1], pendulum_.zmp());
+      }
+      else if (nbContacts == 1)
+      {
+        zmpMargin = contacts[0]->margin(pendulum_.zmp());
+      }
+      Eigen::Vector3d realDCM = realCom_ + realComd_ / pendulum_.omega();
+      dcmError = (pendulum_.dcm() - realDCM).head<2>().norm();
+    }
+    lastPreviewTrigger_ = previewTrigger_.check(timeSinceLastUpdate, previewUpdatePeriod, dcmError, zmpMargin, contactDrift);
+    return (lastPreviewTrigger_ != PreviewUpdateReason::None);
+  }
+
+  PresolveRequest Controller::makePresolveRequest(const Contact & initContact, const Contact & targetContact, const Contact & nextContact, double doubleSupportDuration, bool stop)
+  {
+    PresolveRequest request;
+    request.ankleToTargetCoP = cps.ankleToTargetCoP;
+    request.comHeight = plan.comHeight();
+    request.doubleSupportDuration = doubleSupportDuration;
+    request.initContact = initContact;
+    request.jerkWeight = hmpc.jerkWeight;
+    request.nextContact = nextContact;
+    request.singleSupportDuration = (stop) ? 0. : singleSupportDuration();
+    request.targetContact = targetContact;
+    request.velWeights = hmpc.velWeights;
+    request.wpg = wpg;
+    request.zmpWeight = hmpc.zmpWeight;
+    return request;
+  }
+
+  bool Controller::requestPresolve(double remTime)
+  {
+    unsigned nbSteps = static_cast<unsigned>(remTime / timeStep);
+    if (!presolver.enabled() || !preview || nbSteps < 1 || preview->nbSamples() < nbSteps)
+    {
+      return false;
+    }
+    PresolveRequest request = makePresolveRequest(supportContact(), targetContact(), nextContact(), nextDoubleSupportDuration(), stopAfterSwing());
+    request.initState = preview->lookahead(nbSteps - 1); // predicted touchdown state
+    return presolver.request(request);
+  }
+
+  bool Controller::installPresolvedPreview(double doubleSupportDuration, bool stop)
+  {
+    PresolveRequest actual = makePresolveRequest(prevContact(), supportContact(), targetContact(), doubleSupportDuration, stop);
+    actual.initState = pendulum_;
+    std::shared_ptr<Preview> presolved = presolver.take(actual, timeStep);
+    if (presolved)
+    {
+      preview = presolved;
+      setPreviewInputs(actual);
+      nbPresolvedPreviews_++;
+      return true;
+    }
+    std::shared_ptr<Preview> nominal = takeNominalPreview(actual);
+    if (nominal)
+    {
+      preview = nominal;
+      setPreviewInputs(actual);
+      nbNominalPreviews_++;
+      return true;
+    }
+    return false;
+  }
+
+  void Controller::setPreviewInputs(const PresolveRequest & request)
+  {
+    switch (request.wpg)
+    {
+      case WalkingPatternGeneration::CaptureProblem:
+        cps.contacts(request.initContact, request.targetContact);
+        cps.stepTime(request.doubleSupportDuration);
+        cps.initState(request.initState);
+        cps.targetHeight(request.comHeight);
+        break;
+      case WalkingPatternGeneration::HorizontalMPC:
+        hmpc.contacts(request.initContact, request.targetContact, request.nextContact);
+        hmpc.phaseDurations(0., request.doubleSupportDuration, request.singleSupportDuration);
+        hmpc.initState(request.initState);
+        hmpc.comHeight(request.comHeight);
+        break;
+    }
+  }
+
+  std::shared_ptr<Preview> Controller::takeNominalPreview(const PresolveRequest & actual)
+  {
+    std::shared_ptr<Preview> preview;
+    const StepValidation * step = planValidator_.step(actual.targetContact.id);
+    if (!step || !presolver.matches(step->nominal, actual))
+    {
+      return preview;
+    }
+    switch (actual.wpg)
+    {
+      case WalkingPatternGeneration::CaptureProblem:
+        if (step->cpsSolution)
+        {
+          auto solution = std::make_shared<CaptureSolution>(*step->cpsSolution);
+          solution->sample(actual.initState, timeStep);
+          preview = solution;
+        }
+        break;
+      case WalkingPatternGeneration::HorizontalMPC:
+        if (step->hmpcSolution)
+        {
+          auto solution = std::make_shared<HorizontalMPCSolution>(*step->hmpcSolution);
+          solution->sample(actual.initState, timeStep, actual.initContact, actual.comHeight);
+          preview = solution;
+        }
+        break;
+    }
+    return preview;
+  }
+
+  void Controller::installFallbackPreview()
+  {
+    preview.reset(new StoppingPreview(pendulum_, supportContact()));
+    nbFallbackPreviews_++;
   }
 
   bool Controller::updatePreviewCPS()
   {
+    CycleBudget::ScopedSection section(cycleBudget, CycleSection::Preview);
     cps.initState(pendulum());
     cps.targetHeight(plan.comHeight());
     if (cps.solve())
     {
-      preview.reset(new CaptureSolution(cps.solution()));
+      CaptureSolution * solution = new CaptureSolution(cps.solution());
+      solution->sample(pendulum_, timeStep);
+      preview.reset(solution);
       nbCPSUpdates_++;
       return true;
     }
     else
     {
       nbCPSFailures_++;
+      installFallbackPreview();
       return false;
     }
   }
 
   bool Controller::updatePreviewHMPC()
   {
+    CycleBudget::ScopedSection section(cycleBudget, CycleSection::Preview);
     hmpc.initState(pendulum());
     hmpc.comHeight(plan.comHeight());
     if (hmpc.solve())
     {
-      preview.reset(new HorizontalMPCSolution(hmpc.solution()));
+      // playback plane of the states: previous contact in double support
+      const Contact & plane = (walkingPhase_ == WalkingPhase::DoubleSupport) ? prevContact() : supportContact();
+      HorizontalMPCSolution * solution = new HorizontalMPCSolution(hmpc.solution());
+      solution->sample(pendulum_, timeStep, plane, plan.comHeight());
+      preview.reset(solution);
       nbHMPCUpdates_++;
       return true;
     }
     else
     {
       nbHMPCFailures_++;
+      installFallbackPreview();
       return false;
     }
   }
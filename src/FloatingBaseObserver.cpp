@@ -30,6 +30,7 @@
 #include <mc_rbdyn/rpy_utils.h>
 
 #include <capture_walking/FloatingBaseObserver.h>
+#include <capture_walking/utils/Tracing.h>
 
 namespace capture_walking
 {
@@ -44,16 +45,17 @@ namespace capture_walking
     position_ = X_0_fb.translation();
   }
 
-  void FloatingBaseObserver::run(const mc_rbdyn::Robot & realRobot)
+  void FloatingBaseObserver::run(const mc_rbdyn::Robot & realRobot, const SensorFrame & sensors)
   {
-    estimateOrientation(realRobot);
+    CW_TRACE_SPAN("FloatingBaseObserver::run");
+    estimateOrientation(sensors);
     estimatePosition(realRobot);
   }
 
-  void FloatingBaseObserver::estimateOrientation(const mc_rbdyn::Robot & realRobot)
+  void FloatingBaseObserver::estimateOrientation(const SensorFrame & sensors)
   {
     Eigen::Matrix3d E_0_control = controlRobot_.posW().rotation();
-    Eigen::Matrix3d E_0_imu = realRobot.bodySensor().orientation().toRotationMatrix();
+    const Eigen::Matrix3d & E_0_imu = sensors.imuOrientation;
     Eigen::Vector3d controlRPY = mc_rbdyn::rpyFromMat(E_0_control);
     Eigen::Vector3d realRPY = mc_rbdyn::rpyFromMat(E_0_imu);
     orientation_ = mc_rbdyn::rpyToMat(realRPY(0), realRPY(1), controlRPY(2));
@@ -25,10 +25,70 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
+
 #include <capture_walking/FootstepPlan.h>
 
 namespace capture_walking
 {
+  namespace
+  {
+    /** Plan versions are unique across plan instances, so that a freshly
+     * loaded plan never reuses the version of the one it replaces.
+     *
+     */
+    unsigned newPlanVersion()
+    {
+      static unsigned lastVersion = 0;
+      return ++lastVersion;
+    }
+
+    void fromRecord(const ContactRecord & record, Contact & contact)
+    {
+      Eigen::Matrix3d rotation;
+      rotation << record.rotation[0], record.rotation[1], record.rotation[2],
+               record.rotation[3], record.rotation[4], record.rotation[5],
+               record.rotation[6], record.rotation[7], record.rotation[8];
+      Eigen::Vector3d translation = {record.translation[0], record.translation[1], record.translation[2]};
+      contact.pose = sva::PTransformd(rotation, translation);
+      contact.refVel = {record.refVel[0], record.refVel[1], record.refVel[2]};
+      contact.halfLength = record.halfLength;
+      contact.halfWidth = record.halfWidth;
+      contact.swing.height = record.swingHeight;
+      contact.swing.landingPitch = record.swingLandingPitch;
+      contact.swing.landingRatio = record.swingLandingRatio;
+      contact.swing.takeoffOffset = {record.swingTakeoffOffset[0], record.swingTakeoffOffset[1], record.swingTakeoffOffset[2]};
+      contact.swing.takeoffPitch = record.swingTakeoffPitch;
+      contact.swing.takeoffRatio = record.swingTakeoffRatio;
+      contact.surface = static_cast<ContactSurface>(record.surface);
+      contact.pauseAfterSwing = (record.pauseAfterSwing != 0);
+    }
+
+    void toRecord(const Contact & contact, ContactRecord & record)
+    {
+      const Eigen::Matrix3d & rotation = contact.pose.rotation();
+      for (unsigned i = 0; i < 3; i++)
+      {
+        for (unsigned j = 0; j < 3; j++)
+        {
+          record.rotation[3 * i + j] = rotation(i, j);
+        }
+        record.translation[i] = contact.pose.translation()(i);
+        record.refVel[i] = contact.refVel(i);
+        record.swingTakeoffOffset[i] = contact.swing.takeoffOffset(i);
+      }
+      record.halfLength = contact.halfLength;
+      record.halfWidth = contact.halfWidth;
+      record.swingHeight = contact.swing.height;
+      record.swingLandingPitch = contact.swing.landingPitch;
+      record.swingLandingRatio = contact.swing.landingRatio;
+      record.swingTakeoffPitch = contact.swing.takeoffPitch;
+      record.swingTakeoffRatio = contact.swing.takeoffRatio;
+      record.surface = static_cast<uint32_t>(contact.surface);
+      record.pauseAfterSwing = contact.pauseAfterSwing ? 1 : 0;
+    }
+  }
+
   void FootstepPlan::load(const mc_rtc::Configuration & config)
   {
     config("com_height", comHeight_);
@@ -42,12 +102,85 @@ namespace capture_walking
     config("swing_height", swingHeight_);
     config("takeoff_pitch", takeoffPitch_);
     config("takeoff_ratio", takeoffRatio_);
+    isStreaming_ = false;
+    config("streaming", isStreaming_);
+    if (isStreaming_)
+    {
+      contacts_.reserve(std::max<size_t>(contacts_.size(), STREAMING_PLAN_CAPACITY));
+    }
+    drift_.setZero();
+    driftIndex_ = 0;
+    firstIndex_ = 0;
+    firstStreamedIndex_ = static_cast<unsigned>(contacts_.size());
+    version_ = newPlanVersion();
+  }
+
+  void FootstepPlan::load(const PlanRecord & record, const ContactRecord * contacts)
+  {
+    comHeight_ = record.comHeight;
+    doubleSupportDuration_ = record.doubleSupportDuration;
+    finalDSPDuration_ = record.finalDSPDuration;
+    initDSPDuration_ = record.initDSPDuration;
+    landingPitch_ = record.landingPitch;
+    landingRatio_ = record.landingRatio;
+    singleSupportDuration_ = record.singleSupportDuration;
+    swingHeight_ = record.swingHeight;
+    takeoffOffset_ = {record.takeoffOffset[0], record.takeoffOffset[1], record.takeoffOffset[2]};
+    takeoffPitch_ = record.takeoffPitch;
+    takeoffRatio_ = record.takeoffRatio;
+    isStreaming_ = (record.isStreaming != 0);
+    contacts_.clear();
+    contacts_.reserve(isStreaming_ ? std::max<size_t>(record.nbContacts, STREAMING_PLAN_CAPACITY) : record.nbContacts);
+    contacts_.resize(record.nbContacts);
+    for (unsigned i = 0; i < record.nbContacts; i++)
+    {
+      fromRecord(contacts[i], contacts_[i]);
+      contacts_[i].id = i;
+    }
+    drift_.setZero();
+    driftIndex_ = 0;
+    firstIndex_ = 0;
+    firstStreamedIndex_ = static_cast<unsigned>(contacts_.size());
+    version_ = newPlanVersion();
+  }
+
+  void FootstepPlan::save(PlanRecord & record, std::vector<ContactRecord> & contacts) const
+  {
+    record.comHeight = comHeight_;
+    record.doubleSupportDuration = doubleSupportDuration_;
+    record.finalDSPDuration = finalDSPDuration_;
+    record.initDSPDuration = initDSPDuration_;
+    record.landingPitch = landingPitch_;
+    record.landingRatio = landingRatio_;
+    record.singleSupportDuration = singleSupportDuration_;
+    record.swingHeight = swingHeight_;
+    record.takeoffPitch = takeoffPitch_;
+    record.takeoffRatio = takeoffRatio_;
+    for (unsigned i = 0; i < 3; i++)
+    {
+      record.takeoffOffset[i] = takeoffOffset_(i);
+    }
+    record.isStreaming = isStreaming_ ? 1 : 0;
+    record.firstContact = static_cast<uint32_t>(contacts.size());
+    record.nbContacts = static_cast<uint32_t>(contacts_.size());
+    for (unsigned i = 0; i < contacts_.size(); i++)
+    {
+      Contact contact = contacts_[i];
+      contact.pose = contactPose(firstIndex_ + i);
+      contacts.emplace_back();
+      toRecord(contact, contacts.back());
+    }
   }
 
   void FootstepPlan::save(mc_rtc::Configuration & config) const
   {
+    std::vector<Contact> contacts = contacts_;
+    for (unsigned i = 0; i < contacts.size(); i++)
+    {
+      contacts[i].pose = contactPose(firstIndex_ + i);
+    }
     config.add("com_height", comHeight_);
-    config.add("contacts", contacts_);
+    config.add("contacts", contacts);
     config.add("double_support_duration", doubleSupportDuration_);
     config.add("final_dsp_duration", finalDSPDuration_);
     config.add("init_dsp_duration", initDSPDuration_);
@@ -57,6 +190,10 @@ namespace capture_walking
     config.add("swing_height", swingHeight_);
     config.add("takeoff_pitch", takeoffPitch_);
     config.add("takeoff_ratio", takeoffRatio_);
+    if (isStreaming_)
+    {
+      config.add("streaming", true);
+    }
   }
 
   void FootstepPlan::complete(const Sole & sole)
@@ -64,7 +201,7 @@ namespace capture_walking
     for (unsigned i = 0; i < contacts_.size(); i++)
     {
       auto & contact = contacts_[i];
-      contact.id = i;
+      contact.id = firstIndex_ + i;
       if (contact.halfLength < 1e-4)
       {
         contact.halfLength = sole.halfLength;
@@ -73,18 +210,26 @@ namespace capture_walking
       {
         contact.halfWidth = sole.halfWidth;
       }
-      if (contact.surfaceName.length() < 1)
+      if (contact.surface == ContactSurface::Unknown)
+      {
+        LOG_ERROR("Footstep plan has no valid surface name for contact " << i);
+      }
+      contact.updateGeometry();
+      if (!contact.geometry.isHorizontal)
       {
-        LOG_ERROR("Footstep plan has no surface name for contact " << i);
+        LOG_WARNING("Footstep plan contact " << i << " is not horizontal");
       }
     }
+    version_ = newPlanVersion();
   }
 
   void FootstepPlan::reset(unsigned startIndex)
   {
+    applyDrift();
+    driftIndex_ = 0;
     nextFootstep_ = startIndex + 1;
-    supportContact_ = contacts_[startIndex > 0 ? startIndex - 1 : 0];
-    targetContact_ = contacts_[startIndex];
+    supportContact_ = storedContact(startIndex > firstIndex_ ? startIndex - 1 : firstIndex_);
+    targetContact_ = storedContact(startIndex);
     goToNextFootstep();
   }
 
@@ -93,8 +238,28 @@ namespace capture_walking
     prevContact_ = supportContact_;
     supportContact_ = targetContact_;
     unsigned targetFootstep = nextFootstep_++;
-    targetContact_ = (targetFootstep < contacts_.size()) ? contacts_[targetFootstep] : prevContact_;
-    nextContact_ = (nextFootstep_ < contacts_.size()) ? contacts_[nextFootstep_] : supportContact_;
+    freezeDrift(targetFootstep);
+    if (isStreaming_)
+    {
+      dropPassedContacts();
+    }
+    if (targetFootstep < endIndex())
+    {
+      copyContact(targetFootstep, targetContact_);
+    }
+    else
+    {
+      targetContact_ = prevContact_;
+    }
+    if (nextFootstep_ < endIndex())
+    {
+      copyContact(nextFootstep_, nextContact_);
+    }
+    else
+    {
+      nextContact_ = supportContact_;
+    }
+    version_ = newPlanVersion();
   }
 
   void FootstepPlan::goToNextFootstep(const sva::PTransformd & actualTargetPose)
@@ -102,12 +267,9 @@ namespace capture_walking
     assert(nextFootstep_ >= 1);
     sva::PTransformd poseDrift = actualTargetPose * targetContact_.pose.inv();
     const Eigen::Vector3d & posDrift = poseDrift.translation();
-    sva::PTransformd xyDrift = Eigen::Vector3d{posDrift.x(), posDrift.y(), 0.};
-    for (unsigned i = nextFootstep_ - 1; i < contacts_.size(); i++)
-    {
-      contacts_[i] = xyDrift * contacts_[i];
-    }
-    targetContact_.pose = xyDrift * targetContact_.pose;
+    Eigen::Vector3d xyDrift = {posDrift.x(), posDrift.y(), 0.};
+    drift_ += xyDrift; // applies to contacts from nextFootstep_ - 1 onward
+    targetContact_.translate(xyDrift);
     goToNextFootstep();
   }
 
@@ -117,17 +279,93 @@ namespace capture_walking
     targetContact_ = supportContact_;
     supportContact_ = prevContact_;
     nextFootstep_--;
-    if (nextFootstep_ >= contacts_.size())
+    if (nextFootstep_ >= 1 && driftIndex_ > nextFootstep_ - 1)
+    {
+      // contact becomes the target again, so it will drift with next steps
+      driftIndex_--;
+      storedContact(driftIndex_).translate(-drift_);
+    }
+    if (nextFootstep_ >= endIndex())
     {
       // at goToNextFootstep(), targetContact_ will copy prevContact_
       prevContact_ = nextContact_;
     }
+    version_ = newPlanVersion();
+  }
+
+  bool FootstepPlan::appendContact(const Contact & contact)
+  {
+    if (contacts_.size() >= STREAMING_PLAN_CAPACITY)
+    {
+      return false;
+    }
+    contacts_.push_back(contact);
+    unsigned index = endIndex() - 1;
+    contacts_.back().id = index;
+    contacts_.back().updateGeometry();
+    if (index + 1 == nextFootstep_)
+    {
+      copyContact(index, targetContact_); // plan was starved after last step
+    }
+    else if (index == nextFootstep_)
+    {
+      copyContact(index, nextContact_); // plan was starved during last step
+    }
+    version_ = newPlanVersion();
+    return true;
+  }
+
+  std::vector<Contact> FootstepPlan::streamedContacts() const
+  {
+    std::vector<Contact> contacts;
+    for (unsigned i = std::max(firstStreamedIndex_, nextFootstep_); i < endIndex(); i++)
+    {
+      contacts.emplace_back();
+      copyContact(i, contacts.back());
+    }
+    return contacts;
+  }
+
+  void FootstepPlan::applyDrift()
+  {
+    for (unsigned i = driftIndex_; i < endIndex(); i++)
+    {
+      storedContact(i).translate(drift_);
+    }
+    drift_.setZero();
+  }
+
+  void FootstepPlan::copyContact(unsigned i, Contact & contact) const
+  {
+    contact = contacts_[i - firstIndex_];
+    if (i >= driftIndex_)
+    {
+      contact.translate(drift_);
+    }
+  }
+
+  void FootstepPlan::dropPassedContacts()
+  {
+    if (driftIndex_ > firstIndex_ + STREAMING_PLAN_KEEP_BEHIND)
+    {
+      unsigned nbDropped = driftIndex_ - firstIndex_ - STREAMING_PLAN_KEEP_BEHIND;
+      contacts_.erase(contacts_.begin(), contacts_.begin() + nbDropped);
+      firstIndex_ += nbDropped;
+    }
+  }
+
+  void FootstepPlan::freezeDrift(unsigned endIndex)
+  {
+    for (; driftIndex_ < endIndex && driftIndex_ < this->endIndex(); driftIndex_++)
+    {
+      storedContact(driftIndex_).translate(drift_);
+    }
   }
 
   sva::PTransformd FootstepPlan::computeInitialTransform(const mc_rbdyn::Robot & robot) const
   {
-    sva::PTransformd X_0_c = contacts_[0].pose;
-    const std::string & surfaceName = contacts_[0].surfaceName;
+    sva::PTransformd X_0_c = contactPose(firstIndex_);
+    const std::string surfaceName = contacts_[0].surfaceName();
     const sva::PTransformd & X_0_fb = robot.posW();
     sva::PTransformd X_s_0 = robot.surfacePose(surfaceName).inv();
     sva::PTransformd X_s_fb = X_0_fb * X_s_0;
@@ -0,0 +1,152 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <mc_rbdyn/rpy_utils.h>
+
+#include <capture_walking/FootstepStream.h>
+#include <capture_walking/utils/DeferredLog.h>
+
+namespace capture_walking
+{
+  FootstepStream::~FootstepStream()
+  {
+    close();
+  }
+
+  bool FootstepStream::open(const std::string & path)
+  {
+    close();
+    sockaddr_un address;
+    if (path.size() >= sizeof(address.sun_path))
+    {
+      LOG_ERROR("Footstep stream socket path is too long: " << path);
+      return false;
+    }
+    fd_ = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd_ < 0)
+    {
+      LOG_ERROR("Cannot create footstep stream socket: " << std::strerror(errno));
+      return false;
+    }
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    ::unlink(path.c_str());
+    if (::bind(fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+    {
+      LOG_ERROR("Cannot bind footstep stream socket to " << path << ": " << std::strerror(errno));
+      ::close(fd_);
+      fd_ = -1;
+      return false;
+    }
+    path_ = path;
+    hasPending_ = false;
+    LOG_INFO("Receiving streamed footsteps on " << path);
+    return true;
+  }
+
+  void FootstepStream::close()
+  {
+    if (fd_ < 0)
+    {
+      return;
+    }
+    ::close(fd_);
+    ::unlink(path_.c_str());
+    fd_ = -1;
+  }
+
+  unsigned FootstepStream::receive(FootstepPlan & plan, const Sole & sole)
+  {
+    unsigned nbAppended = 0;
+    while (fd_ >= 0)
+    {
+      if (!hasPending_)
+      {
+        StreamedFootstep footstep;
+        ssize_t size = ::recv(fd_, &footstep, sizeof(footstep), MSG_DONTWAIT);
+        if (size < 0)
+        {
+          if (errno != EAGAIN && errno != EWOULDBLOCK)
+          {
+            CW_LOG_ERROR("Footstep stream receive failed with errno {}", errno);
+          }
+          break;
+        }
+        if (size != static_cast<ssize_t>(sizeof(footstep)) || !toContact(footstep, sole))
+        {
+          CW_LOG_WARNING("Discarding invalid streamed footstep ({} bytes)", size);
+          continue;
+        }
+        hasPending_ = true;
+      }
+      if (!plan.appendContact(pending_))
+      {
+        break; // plan is full, try again at next cycle
+      }
+      hasPending_ = false;
+      nbAppended++;
+      nbReceived_++;
+    }
+    return nbAppended;
+  }
+
+  bool FootstepStream::toContact(const StreamedFootstep & footstep, const Sole & sole)
+  {
+    if (footstep.magic != FOOTSTEP_STREAM_MAGIC)
+    {
+      return false;
+    }
+    switch (footstep.surface)
+    {
+      case 1:
+        pending_.surface = ContactSurface::LeftFootCenter;
+        break;
+      case 2:
+        pending_.surface = ContactSurface::RightFootCenter;
+        break;
+      default:
+        return false;
+    }
+    Eigen::Vector3d position = {footstep.position[0], footstep.position[1], footstep.position[2]};
+    Eigen::Matrix3d rotation = mc_rbdyn::rpyToMat(footstep.rpy[0], footstep.rpy[1], footstep.rpy[2]);
+    pending_.pose = sva::PTransformd(rotation, position);
+    pending_.halfLength = (footstep.halfLength > 1e-4) ? footstep.halfLength : sole.halfLength;
+    pending_.halfWidth = (footstep.halfWidth > 1e-4) ? footstep.halfWidth : sole.halfWidth;
+    pending_.pauseAfterSwing = (footstep.pauseAfterSwing != 0);
+    pending_.refVel.setZero();
+    pending_.swing = SwingParams();
+    return true;
+  }
+}
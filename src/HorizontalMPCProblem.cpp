@@ -28,6 +28,8 @@
 #include <iomanip>
 
 #include <capture_walking/HorizontalMPCProblem.h>
+#include <capture_walking/utils/DeferredLog.h>
+#include <capture_walking/utils/Tracing.h>
 #include <capture_walking/utils/clamp.h>
 
 namespace capture_walking
@@ -129,43 +131,19 @@ namespace capture_walking
     }
   }
 
-  Eigen::HrepXd HorizontalMPCProblem::getSingleSupportHrep(const Contact & contact)
-  {
-    Eigen::Matrix<double, 4, 2> contactHrepMat, worldHrepMat;
-    Eigen::Matrix<double, 4, 1> contactHrepVec, worldHrepVec;
-    contactHrepMat <<
-      +1, 0,
-      -1, 0,
-      0, +1,
-      0, -1;
-    contactHrepVec <<
-      contact.halfLength,
-      contact.halfLength,
-      contact.halfWidth,
-      contact.halfWidth;
-    if ((contact.normal() - world::e_z).norm() > 1e-3)
-    {
-      LOG_ERROR("Contact is not horizontal");
-    }
-    sva::PTransformd X_0_c = contact.pose;
-    worldHrepMat = contactHrepMat * X_0_c.rotation().topLeftCorner<2, 2>();
-    worldHrepVec = worldHrepMat * X_0_c.translation().head<2>() + contactHrepVec;
-    return Eigen::HrepXd(worldHrepMat, worldHrepVec);
-  }
-
   void HorizontalMPCProblem::computeZMPRef()
   {
     velRef_.setZero();
     zmpRef_.setZero();
-    Eigen::Vector2d p_0 = initContact_.anklePos().head<2>();
-    Eigen::Vector2d p_1 = targetContact_.anklePos().head<2>();
-    Eigen::Vector2d p_2 = nextContact_.anklePos().head<2>();
+    Eigen::Vector2d p_0 = initContact_.geometry.anklePos.head<2>();
+    Eigen::Vector2d p_1 = targetContact_.geometry.anklePos.head<2>();
+    Eigen::Vector2d p_2 = nextContact_.geometry.anklePos.head<2>();
     Eigen::Vector2d v_0 = initContact_.refVel.head<2>();
     Eigen::Vector2d v_1 = targetContact_.refVel.head<2>();
     Eigen::Vector2d v_2 = nextContact_.refVel.head<2>();
     if (nbTargetSupportSteps_ < 1) // stop during first DSP
     {
-      p_1 = 0.5 * (initContact_.anklePos() + targetContact_.anklePos()).head<2>();
+      p_1 = 0.5 * (p_0 + p_1);
       v_1 = {0., 0.};
     }
     for (long i = 0; i <= NB_STEPS; i++)
@@ -197,6 +175,7 @@ namespace capture_walking
 
   void HorizontalMPCProblem::updateTerminalConstraint()
   {
+    CW_TRACE_SPAN("HorizontalMPCProblem::updateTerminalConstraint");
     Eigen::MatrixXd E_dcm = Eigen::MatrixXd::Zero(2, STATE_SIZE * (NB_STEPS + 1));
     Eigen::MatrixXd E_zmp = Eigen::MatrixXd::Zero(2, STATE_SIZE * (NB_STEPS + 1));
     if (nbTargetSupportSteps_ < 1) // half preview
@@ -218,16 +197,18 @@ namespace capture_walking
 
   void HorizontalMPCProblem::updateZMPConstraint()
   {
-    hreps_[0] = getSingleSupportHrep(initContact_);
-    hreps_[2] = getSingleSupportHrep(targetContact_);
+    CW_TRACE_SPAN("HorizontalMPCProblem::updateZMPConstraint");
+    const ContactGeometry * hreps[4] = {&initContact_.geometry, nullptr, &targetContact_.geometry, nullptr};
+    if (!initContact_.geometry.isHorizontal || !targetContact_.geometry.isHorizontal)
+    {
+      CW_LOG_ERROR("Contact is not horizontal");
+    }
     long totalRows = 0;
     for (long i = 0; i <= NB_STEPS; i++)
     {
-      unsigned hrepIndex = indexToHrep[i];
-      if (hrepIndex % 2 == 0)
+      if (indexToHrep[i] % 2 == 0)
       {
-        const auto & hrep = hreps_[hrepIndex];
-        totalRows += static_cast<unsigned>(hrep.first.rows());
+        totalRows += 4;
       }
     }
     Eigen::MatrixXd A{totalRows, STATE_SIZE * (NB_STEPS + 1)};
@@ -239,11 +220,10 @@ namespace capture_walking
       unsigned hrepIndex = indexToHrep[i];
       if (hrepIndex % 2 == 0)
       {
-        const auto & hrep = hreps_[indexToHrep[i]];
-        unsigned consRows = static_cast<unsigned>(hrep.first.rows());
-        A.block(nextRow, STATE_SIZE * i, consRows, STATE_SIZE) = hrep.first * zmpFromState_;
-        b.segment(nextRow, consRows) = hrep.second;
-        nextRow += consRows;
+        const ContactGeometry & hrep = *hreps[hrepIndex];
+        A.block<4, STATE_SIZE>(nextRow, STATE_SIZE * i) = hrep.hrepMat * zmpFromState_;
+        b.segment<4>(nextRow) = hrep.hrepVec;
+        nextRow += 4;
       }
     }
     zmpCons_ = std::make_shared<copra::TrajectoryConstraint>(A, b);
@@ -251,6 +231,7 @@ namespace capture_walking
 
   void HorizontalMPCProblem::updateJerkCost()
   {
+    CW_TRACE_SPAN("HorizontalMPCProblem::updateJerkCost");
     Eigen::Matrix2d jerkMat = Eigen::Matrix2d::Identity();
     Eigen::Vector2d jerkVec = Eigen::Vector2d::Zero();
     jerkCost_ = std::make_shared<copra::ControlCost>(jerkMat, jerkVec);
@@ -259,6 +240,7 @@ namespace capture_walking
 
   void HorizontalMPCProblem::updateVelCost()
   {
+    CW_TRACE_SPAN("HorizontalMPCProblem::updateVelCost");
     velCost_ = std::make_shared<copra::TrajectoryCost>(velFromState_, velRef_);
     velCost_->weights(velWeights);
     velCost_->autoSpan(); // repeat zmpFromState
@@ -266,6 +248,7 @@ namespace capture_walking
 
   void HorizontalMPCProblem::updateZMPCost()
   {
+    CW_TRACE_SPAN("HorizontalMPCProblem::updateZMPCost");
     zmpCost_ = std::make_shared<copra::TrajectoryCost>(zmpFromState_, zmpRef_);
     zmpCost_->weight(zmpWeight);
     zmpCost_->autoSpan(); // repeat zmpFromState
@@ -273,6 +256,7 @@ namespace capture_walking
 
   bool HorizontalMPCProblem::solve()
   {
+    CW_TRACE_SPAN("HorizontalMPCProblem::solve");
     computeZMPRef();
 
     previewSystem_->xInit(initState_);
@@ -292,7 +276,7 @@ namespace capture_walking
 
     if (!lmpc.solve())
     {
-      LOG_ERROR("Horizontal MPC problem has no solution");
+      CW_LOG_ERROR("Horizontal MPC problem has no solution");
       solution_ = HorizontalMPCSolution(initState_);
       //writePython("failure");
       return false;
@@ -28,6 +28,7 @@
 #include <fstream>
 
 #include <capture_walking/HorizontalMPCSolution.h>
+#include <capture_walking/utils/DeferredLog.h>
 
 namespace capture_walking
 {
@@ -44,13 +45,41 @@ namespace capture_walking
   {
     if (stateTraj.size() / STATE_SIZE != 1 + jerkTraj.size() / INPUT_SIZE)
     {
-      LOG_ERROR("Invalid state/input sizes, respectively " << stateTraj.size() << " and " << jerkTraj.size());
+      CW_LOG_ERROR("Invalid state/input sizes, respectively {} and {}", stateTraj.size(), jerkTraj.size());
     }
     jerkTraj_ = jerkTraj;
     stateTraj_ = stateTraj;
   }
 
+  void HorizontalMPCSolution::sample(const Pendulum & state, double dt, const Contact & plane, double comHeight)
+  {
+    clearSamples(dt);
+    double initPlaybackTime = playbackTime_;
+    unsigned initPlaybackStep = playbackStep_;
+    double horizon = NB_STEPS * SAMPLING_PERIOD - playbackTime_;
+    unsigned nbSamples = std::min(PREVIEW_BUFFER_SIZE, static_cast<unsigned>(std::max(horizon, 0.) / dt));
+    Pendulum sampledState = state;
+    for (unsigned i = 0; i < nbSamples; i++)
+    {
+      integrateSolution(sampledState, dt);
+      sampledState.resetCoMHeight(comHeight, plane);
+      sampledState.completeIPM(plane);
+      pushSample(sampledState);
+    }
+    playbackTime_ = initPlaybackTime;
+    playbackStep_ = initPlaybackStep;
+  }
+
   void HorizontalMPCSolution::integrate(Pendulum & pendulum, double dt)
+  {
+    if (playSample(pendulum, dt))
+    {
+      return;
+    }
+    integrateSolution(pendulum, dt);
+  }
+
+  void HorizontalMPCSolution::integrateSolution(Pendulum & pendulum, double dt)
   {
     if (playbackStep_ < NB_STEPS)
     {
@@ -83,7 +112,7 @@ namespace capture_walking
     Eigen::Vector2d comdd_f = lastState.segment<2>(4);
     if (std::abs(comd_f.x() * comdd_f.y() - comd_f.y() * comdd_f.x()) > 1e-4)
     {
-      LOG_WARNING("HMPC terminal condition is not properly fulfilled");
+      CW_LOG_WARNING("HMPC terminal condition is not properly fulfilled");
     }
     double omega_f = -comd_f.dot(comdd_f) / comd_f.dot(comd_f);
     double lambda_f = std::pow(omega_f, 2);
@@ -26,6 +26,8 @@
  */
 
 #include <capture_walking/PendulumObserver.h>
+#include <capture_walking/utils/DeferredLog.h>
+#include <capture_walking/utils/Tracing.h>
 
 namespace capture_walking
 {
@@ -35,8 +37,10 @@ namespace capture_walking
   {
   }
 
-  void PendulumObserver::update(const Eigen::Vector3d & comGuess, const sva::ForceVecd & contactWrench, const Contact & contact)
+  void PendulumObserver::update(const Eigen::Vector3d & comGuess, const SensorFrame & sensors, const Contact & contact)
   {
+    CW_TRACE_SPAN("PendulumObserver::update");
+    const sva::ForceVecd & contactWrench = sensors.netWrench;
     const Eigen::Vector3d & force = contactWrench.force();
     const Eigen::Vector3d & moment_0 = contactWrench.couple();
     Eigen::Vector3d moment_p = moment_0 - contact.p().cross(force);
@@ -59,7 +63,7 @@ namespace capture_walking
     omega_ = std::sqrt(lambda);
     if ((contactForce() - force).norm() > 1e-5)
     {
-      LOG_ERROR("error in estimated contact force computation");
+      CW_LOG_ERROR("error in estimated contact force computation");
     }
   }
 }
@@ -0,0 +1,136 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <mc_rtc/logging.h>
+
+#include <capture_walking/PlanLibrary.h>
+
+namespace capture_walking
+{
+  PlanLibrary::~PlanLibrary()
+  {
+    close();
+  }
+
+  bool PlanLibrary::open(const std::string & path)
+  {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+      LOG_ERROR("Cannot open plan library " << path << ": " << std::strerror(errno));
+      return false;
+    }
+    struct stat status;
+    if (::fstat(fd, &status) < 0 || status.st_size < static_cast<off_t>(sizeof(PlanLibraryHeader)))
+    {
+      LOG_ERROR("Plan library " << path << " is truncated");
+      ::close(fd);
+      return false;
+    }
+    size_t size = static_cast<size_t>(status.st_size);
+    void * data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+      LOG_ERROR("Cannot map plan library " << path << ": " << std::strerror(errno));
+      return false;
+    }
+    auto header = static_cast<const PlanLibraryHeader *>(data);
+    size_t expectedSize = sizeof(PlanLibraryHeader) + header->nbPlans * sizeof(PlanRecord) + header->nbContacts * sizeof(ContactRecord);
+    if (header->magic != PLAN_LIBRARY_MAGIC || header->version != PLAN_LIBRARY_VERSION)
+    {
+      LOG_ERROR("Plan library " << path << " has an unsupported format, recompile it");
+      ::munmap(data, size);
+      return false;
+    }
+    if (size != expectedSize)
+    {
+      LOG_ERROR("Plan library " << path << " has " << size << " bytes but " << expectedSize << " were expected");
+      ::munmap(data, size);
+      return false;
+    }
+    auto plans = reinterpret_cast<const PlanRecord *>(header + 1);
+    for (unsigned i = 0; i < header->nbPlans; i++)
+    {
+      const PlanRecord & plan = plans[i];
+      if (plan.name[PLAN_NAME_SIZE - 1] != '\0' || plan.firstContact + plan.nbContacts > header->nbContacts)
+      {
+        LOG_ERROR("Plan library " << path << " has an invalid record for plan " << i);
+        ::munmap(data, size);
+        return false;
+      }
+    }
+    data_ = data;
+    size_ = size;
+    header_ = header;
+    plans_ = plans;
+    contacts_ = reinterpret_cast<const ContactRecord *>(plans + header->nbPlans);
+    LOG_INFO("Loaded " << header->nbPlans << " precompiled footstep plans from " << path);
+    return true;
+  }
+
+  void PlanLibrary::close()
+  {
+    if (data_ == nullptr)
+    {
+      return;
+    }
+    ::munmap(data_, size_);
+    contacts_ = nullptr;
+    data_ = nullptr;
+    header_ = nullptr;
+    plans_ = nullptr;
+    size_ = 0;
+  }
+
+  int PlanLibrary::find(const std::string & name) const
+  {
+    for (unsigned i = 0; i < nbPlans(); i++)
+    {
+      if (std::strncmp(plans_[i].name, name.c_str(), PLAN_NAME_SIZE) == 0)
+      {
+        return static_cast<int>(i);
+      }
+    }
+    return -1;
+  }
+
+  void PlanLibrary::instantiate(unsigned index, FootstepPlan & plan) const
+  {
+    const PlanRecord & record = plans_[index];
+    plan.load(record, contacts_ + record.firstContact);
+  }
+}
@@ -0,0 +1,244 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#include <mc_rtc/logging.h>
+
+#include <capture_walking/PlanValidator.h>
+
+namespace capture_walking
+{
+  namespace
+  {
+    const char * cpsStatusName(cps::SolverStatus status)
+    {
+      switch (status)
+      {
+        case cps::SolverStatus::Converge:
+          return "converged";
+        case cps::SolverStatus::MaxIteration:
+          return "max iterations";
+        case cps::SolverStatus::LineSearchFailed:
+          return "line search failed";
+        case cps::SolverStatus::NoLinearlyFeasiblePoint:
+          return "not linearly feasible";
+        case cps::SolverStatus::NumericallyEquivalentIterates:
+          return "numerically equivalent iterates";
+        case cps::SolverStatus::Fail:
+          return "fail";
+        default:
+          return "unknown";
+      }
+    }
+  }
+
+  PlanValidator::~PlanValidator()
+  {
+    cancel();
+  }
+
+  void PlanValidator::configure(const mc_rtc::Configuration & config)
+  {
+    config("enabled", enabled_);
+    config("threads", nbThreads_);
+    config("verbose", verbose_);
+  }
+
+  void PlanValidator::cancel()
+  {
+    stop_ = true;
+    for (std::thread & worker : workers_)
+    {
+      worker.join();
+    }
+    workers_.clear();
+    stop_ = false;
+  }
+
+  void PlanValidator::start(FootstepPlan & plan, const PresolveRequest & defaults)
+  {
+    cancel();
+    isDone_ = false;
+    nbValidated_ = 0;
+    nextStep_ = 0;
+    planName_ = plan.name;
+    steps_.clear();
+
+    const std::vector<Contact> & contacts = plan.contacts();
+    firstTargetId_ = plan.firstIndex() + 1;
+    for (unsigned i = 1; i < contacts.size(); i++)
+    {
+      const Contact & initContact = contacts[i - 1];
+      const Contact & targetContact = contacts[i];
+      bool isLast = (i + 1 >= contacts.size());
+      bool pause = (i >= 2 && contacts[i - 2].pauseAfterSwing); // swing foot took off from it, see Controller::isPauseRequested()
+      bool stop = isLast || pause;
+      steps_.emplace_back();
+      PresolveRequest & nominal = steps_.back().nominal;
+      nominal = defaults;
+      nominal.initContact = initContact;
+      nominal.targetContact = targetContact;
+      nominal.nextContact = isLast ? targetContact : contacts[i + 1];
+      nominal.comHeight = plan.comHeight();
+      nominal.doubleSupportDuration = stop ? plan.finalDSPDuration() : plan.doubleSupportDuration();
+      nominal.singleSupportDuration = stop ? 0. : plan.singleSupportDuration();
+
+      // nominal touchdown state: CoM between ankles, moving at average speed
+      const Eigen::Vector3d & initAnkle = initContact.geometry.anklePos;
+      const Eigen::Vector3d & targetAnkle = targetContact.geometry.anklePos;
+      double stepDuration = plan.doubleSupportDuration() + plan.singleSupportDuration();
+      Eigen::Vector3d com = 0.5 * (initAnkle + targetAnkle) + plan.comHeight() * world::e_z;
+      Eigen::Vector3d comd = (targetAnkle - initAnkle) / std::max(stepDuration, 1e-3);
+      comd.z() = 0.;
+      nominal.initState.reset(com, comd);
+    }
+    if (steps_.empty())
+    {
+      isDone_ = true;
+      return;
+    }
+
+    unsigned nbThreads = (nbThreads_ > 0) ? nbThreads_ : std::thread::hardware_concurrency();
+    nbThreads = std::max(1u, std::min(nbThreads, static_cast<unsigned>(steps_.size())));
+    startTime_ = std::chrono::steady_clock::now();
+    bool applyPolicy = true;
+    for (unsigned i = 0; i < nbThreads; i++)
+    {
+      workers_.emplace_back(&PlanValidator::workerLoop, this);
+      if (applyPolicy)
+      {
+        applyPolicy = threadPolicy_.apply(workers_.back()); // warn once
+      }
+    }
+  }
+
+  const StepValidation * PlanValidator::step(unsigned targetId) const
+  {
+    if (!isDone() || targetId < firstTargetId_ || targetId >= firstTargetId_ + steps_.size())
+    {
+      return nullptr;
+    }
+    return &steps_[targetId - firstTargetId_];
+  }
+
+  void PlanValidator::validate(CaptureProblem & cps, HorizontalMPCProblem & hmpc, StepValidation & step)
+  {
+    const PresolveRequest & nominal = step.nominal;
+
+    cps.ankleToTargetCoP = nominal.ankleToTargetCoP;
+    cps.contacts(nominal.initContact, nominal.targetContact);
+    cps.stepTime(nominal.doubleSupportDuration);
+    cps.initState(nominal.initState);
+    cps.targetHeight(nominal.comHeight);
+    bool cpsSuccess = cps.solve();
+    step.alphaIntervals = cps.alphaIntervals();
+    step.cpsStatus = cps.status();
+    if (cpsSuccess)
+    {
+      step.cpsSolution = std::make_shared<CaptureSolution>(cps.solution());
+      step.stepTimeError = step.cpsSolution->stepTime() - nominal.doubleSupportDuration;
+    }
+
+    hmpc.jerkWeight = nominal.jerkWeight;
+    hmpc.velWeights = nominal.velWeights;
+    hmpc.zmpWeight = nominal.zmpWeight;
+    hmpc.contacts(nominal.initContact, nominal.targetContact, nominal.nextContact);
+    hmpc.phaseDurations(0., nominal.doubleSupportDuration, nominal.singleSupportDuration);
+    hmpc.initState(nominal.initState);
+    hmpc.comHeight(nominal.comHeight);
+    if (hmpc.solve())
+    {
+      step.hmpcSolution = std::make_shared<HorizontalMPCSolution>(hmpc.solution());
+    }
+  }
+
+  void PlanValidator::workerLoop()
+  {
+    CaptureProblem cps;
+    HorizontalMPCProblem hmpc;
+    unsigned nbSteps = static_cast<unsigned>(steps_.size());
+    while (!stop_)
+    {
+      unsigned i = nextStep_.fetch_add(1);
+      if (i >= nbSteps)
+      {
+        break;
+      }
+      validate(cps, hmpc, steps_[i]);
+      if (nbValidated_.fetch_add(1, std::memory_order_acq_rel) + 1 == nbSteps)
+      {
+        report();
+      }
+    }
+  }
+
+  void PlanValidator::report()
+  {
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime_);
+    nbInfeasibleSteps_ = 0;
+    for (unsigned i = 0; i < steps_.size(); i++)
+    {
+      const StepValidation & step = steps_[i];
+      bool isFeasible = (step.cpsSolution && step.hmpcSolution);
+      if (!isFeasible)
+      {
+        nbInfeasibleSteps_++;
+      }
+      if (isFeasible && !verbose_)
+      {
+        continue;
+      }
+      std::string intervals = "";
+      for (const Interval & interval : step.alphaIntervals)
+      {
+        intervals += " [" + std::to_string(interval.lower) + ", " + std::to_string(interval.upper) + "]";
+      }
+      std::string message = "Step to contact " + std::to_string(firstTargetId_ + i) + ": CPS " + cpsStatusName(step.cpsStatus)
+        + " (step time error " + std::to_string(step.stepTimeError) + " s, alpha intervals:" + intervals + "), HMPC "
+        + (step.hmpcSolution ? "solved" : "has no solution");
+      if (isFeasible)
+      {
+        LOG_INFO(message);
+      }
+      else
+      {
+        LOG_WARNING(message);
+      }
+    }
+    if (nbInfeasibleSteps_ > 0)
+    {
+      LOG_WARNING("Footstep plan \"" << planName_ << "\" has " << nbInfeasibleSteps_ << " infeasible steps out of " << steps_.size()
+          << " (validated in " << duration.count() << " ms)");
+    }
+    else
+    {
+      LOG_INFO("Footstep plan \"" << planName_ << "\" validated: " << steps_.size() << " feasible steps in " << duration.count() << " ms");
+    }
+    isDone_.store(true, std::memory_order_release);
+  }
+}
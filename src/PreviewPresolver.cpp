@@ -0,0 +1,232 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <capture_walking/PreviewPresolver.h>
+
+namespace capture_walking
+{
+  namespace
+  {
+    constexpr double DURATION_TOLERANCE = 1e-6; // [s]
+  }
+
+  PreviewPresolver::~PreviewPresolver()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    condition_.notify_all();
+    if (worker_.joinable())
+    {
+      worker_.join();
+    }
+  }
+
+  void PreviewPresolver::configure(const mc_rtc::Configuration & config)
+  {
+    config("enabled", enabled_);
+    config("max_com_error", maxComError_);
+    config("max_comd_error", maxComdError_);
+    config("max_comdd_error", maxComddError_);
+    config("max_contact_error", maxContactError_);
+    config("window", window_);
+    if (enabled_ && !worker_.joinable())
+    {
+      worker_ = std::thread(&PreviewPresolver::workerLoop, this);
+      threadPolicy_.apply(worker_);
+    }
+  }
+
+  void PreviewPresolver::threadPolicy(const ThreadPolicy & policy)
+  {
+    threadPolicy_ = policy;
+    threadPolicy_.apply(worker_);
+  }
+
+  void PreviewPresolver::cancel()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    generation_++;
+    status_ = Status::Idle;
+    cpsSolution_.reset();
+    hmpcSolution_.reset();
+  }
+
+  bool PreviewPresolver::request(const PresolveRequest & request)
+  {
+    std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+    if (!enabled_ || !lock.owns_lock() || status_ == Status::Pending || status_ == Status::Solving)
+    {
+      return false;
+    }
+    request_ = request;
+    generation_++;
+    status_ = Status::Pending;
+    cpsSolution_.reset();
+    hmpcSolution_.reset();
+    lock.unlock();
+    condition_.notify_one();
+    return true;
+  }
+
+  std::shared_ptr<Preview> PreviewPresolver::take(const PresolveRequest & actual, double dt)
+  {
+    std::shared_ptr<Preview> preview;
+    std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+    if (!lock.owns_lock())
+    {
+      return preview;
+    }
+    if (status_ == Status::Ready && matches(request_, actual))
+    {
+      switch (actual.wpg)
+      {
+        case WalkingPatternGeneration::CaptureProblem:
+          cpsSolution_->sample(actual.initState, dt);
+          preview = cpsSolution_;
+          break;
+        case WalkingPatternGeneration::HorizontalMPC:
+          hmpcSolution_->sample(actual.initState, dt, actual.initContact, actual.comHeight); // played in DSP over initContact
+          preview = hmpcSolution_;
+          break;
+      }
+    }
+    generation_++; // discard computation in progress, if any
+    status_ = Status::Idle;
+    cpsSolution_.reset();
+    hmpcSolution_.reset();
+    return preview;
+  }
+
+  bool PreviewPresolver::matches(const PresolveRequest & expected, const PresolveRequest & actual) const
+  {
+    auto contactsMatch = [this](const Contact & c1, const Contact & c2)
+    {
+      return (c1.id == c2.id && (c1.p() - c2.p()).norm() < maxContactError_);
+    };
+    if (actual.wpg != expected.wpg)
+    {
+      return false;
+    }
+    if (std::abs(actual.comHeight - expected.comHeight) > 1e-6 ||
+        std::abs(actual.doubleSupportDuration - expected.doubleSupportDuration) > DURATION_TOLERANCE ||
+        std::abs(actual.singleSupportDuration - expected.singleSupportDuration) > DURATION_TOLERANCE)
+    {
+      return false;
+    }
+    if (actual.ankleToTargetCoP != expected.ankleToTargetCoP ||
+        actual.velWeights != expected.velWeights ||
+        actual.jerkWeight != expected.jerkWeight ||
+        actual.zmpWeight != expected.zmpWeight)
+    {
+      return false;
+    }
+    if (!contactsMatch(actual.initContact, expected.initContact) ||
+        !contactsMatch(actual.targetContact, expected.targetContact) ||
+        !contactsMatch(actual.nextContact, expected.nextContact))
+    {
+      return false;
+    }
+    double comError = (actual.initState.com() - expected.initState.com()).norm();
+    double comdError = (actual.initState.comd() - expected.initState.comd()).norm();
+    if (comError >= maxComError_ || comdError >= maxComdError_)
+    {
+      return false;
+    }
+    if (actual.wpg == WalkingPatternGeneration::HorizontalMPC)
+    {
+      // HMPC initial state includes acceleration, i.e. the initial ZMP
+      double comddError = (actual.initState.comdd() - expected.initState.comdd()).norm();
+      return (comddError < maxComddError_);
+    }
+    return true;
+  }
+
+  bool PreviewPresolver::solve(const PresolveRequest & request, std::shared_ptr<CaptureSolution> & cpsSolution, std::shared_ptr<HorizontalMPCSolution> & hmpcSolution)
+  {
+    switch (request.wpg)
+    {
+      case WalkingPatternGeneration::CaptureProblem:
+        cps_.ankleToTargetCoP = request.ankleToTargetCoP;
+        cps_.contacts(request.initContact, request.targetContact);
+        cps_.stepTime(request.doubleSupportDuration);
+        cps_.initState(request.initState);
+        cps_.targetHeight(request.comHeight);
+        if (!cps_.solve())
+        {
+          return false;
+        }
+        cpsSolution = std::make_shared<CaptureSolution>(cps_.solution());
+        return true;
+      case WalkingPatternGeneration::HorizontalMPC:
+        hmpc_.jerkWeight = request.jerkWeight;
+        hmpc_.velWeights = request.velWeights;
+        hmpc_.zmpWeight = request.zmpWeight;
+        hmpc_.contacts(request.initContact, request.targetContact, request.nextContact);
+        hmpc_.phaseDurations(0., request.doubleSupportDuration, request.singleSupportDuration);
+        hmpc_.initState(request.initState);
+        hmpc_.comHeight(request.comHeight);
+        if (!hmpc_.solve())
+        {
+          return false;
+        }
+        hmpcSolution = std::make_shared<HorizontalMPCSolution>(hmpc_.solution());
+        return true;
+    }
+    return false;
+  }
+
+  void PreviewPresolver::workerLoop()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_)
+    {
+      condition_.wait(lock, [this]() { return stop_ || status_ == Status::Pending; });
+      if (stop_)
+      {
+        break;
+      }
+      PresolveRequest request = request_;
+      unsigned generation = generation_;
+      status_ = Status::Solving;
+      lock.unlock();
+
+      std::shared_ptr<CaptureSolution> cpsSolution;
+      std::shared_ptr<HorizontalMPCSolution> hmpcSolution;
+      bool success = solve(request, cpsSolution, hmpcSolution);
+
+      lock.lock();
+      if (generation == generation_ && status_ == Status::Solving)
+      {
+        status_ = (success) ? Status::Ready : Status::Idle;
+        cpsSolution_ = cpsSolution;
+        hmpcSolution_ = hmpcSolution;
+      }
+    }
+  }
+}
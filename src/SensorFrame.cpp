@@ -0,0 +1,107 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <mc_rtc/logging.h>
+
+#include <capture_walking/SensorFrame.h>
+#include <capture_walking/utils/Tracing.h>
+
+namespace capture_walking
+{
+  namespace
+  {
+    constexpr double CONTACT_PRESSURE = 30.; // [N]
+    constexpr double MIN_WRENCH_PRESSURE = 1.; // [N] below which foot wrenches are noise
+
+    unsigned findForceSensor(const mc_rbdyn::Robot & robot, const std::string & name)
+    {
+      const auto & sensors = robot.forceSensors();
+      for (unsigned i = 0; i < sensors.size(); i++)
+      {
+        if (sensors[i].name() == name)
+        {
+          return i;
+        }
+      }
+      LOG_ERROR_AND_THROW(std::runtime_error, "No force sensor named " << name);
+    }
+
+    void readFoot(const mc_rbdyn::Robot & robot, const mc_rbdyn::ForceSensor & sensor, const mc_rbdyn::Surface & surface, SensorFrame::Foot & foot)
+    {
+      // relative transform, hence independent from the floating-base estimate
+      sva::PTransformd X_sensor_surface = surface.X_0_s(robot) * sensor.X_0_f(robot).inv();
+      // gravity-compensated like worldWrench and CoPTask::measuredWrench()
+      foot.surfaceWrench = X_sensor_surface.dualMul(sensor.wrenchWithoutGravity(robot));
+      foot.pressure = foot.surfaceWrench.force().z();
+      foot.isInContact = (foot.pressure > CONTACT_PRESSURE);
+      if (foot.pressure > MIN_WRENCH_PRESSURE)
+      {
+        const Eigen::Vector3d & tau = foot.surfaceWrench.couple();
+        foot.cop = Eigen::Vector2d{-tau.y(), tau.x()} / foot.pressure;
+      }
+      else
+      {
+        foot.cop.setZero();
+      }
+    }
+  }
+
+  void SensorFrame::resolve(const mc_rbdyn::Robot & robot)
+  {
+    leftFootSensorIndex_ = findForceSensor(robot, "LeftFootForceSensor");
+    rightFootSensorIndex_ = findForceSensor(robot, "RightFootForceSensor");
+    leftFootSurface_ = &robot.surface("LeftFootCenter");
+    rightFootSurface_ = &robot.surface("RightFootCenter");
+  }
+
+  void SensorFrame::read(const mc_rbdyn::Robot & robot)
+  {
+    CW_TRACE_SPAN("SensorFrame::read");
+    if (!leftFootSurface_)
+    {
+      resolve(robot);
+    }
+    const auto & sensors = robot.forceSensors();
+    readFoot(robot, sensors[leftFootSensorIndex_], *leftFootSurface_, leftFoot);
+    readFoot(robot, sensors[rightFootSensorIndex_], *rightFootSurface_, rightFoot);
+    imuOrientation = robot.bodySensor().orientation().toRotationMatrix();
+  }
+
+  void SensorFrame::updateWorldWrenches(const mc_rbdyn::Robot & robot)
+  {
+    const auto & sensors = robot.forceSensors();
+    leftFoot.worldWrench = sensors[leftFootSensorIndex_].worldWrench(robot);
+    rightFoot.worldWrench = sensors[rightFootSensorIndex_].worldWrench(robot);
+    netWrench = sva::ForceVecd(Eigen::Vector6d::Zero());
+    for (const Foot * foot : {&leftFoot, &rightFoot})
+    {
+      if (foot->pressure > MIN_WRENCH_PRESSURE)
+      {
+        netWrench += foot->worldWrench;
+      }
+    }
+  }
+}
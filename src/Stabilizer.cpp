@@ -28,6 +28,8 @@
 #include <mc_rbdyn/rpy_utils.h>
 
 #include <capture_walking/Stabilizer.h>
+#include <capture_walking/utils/DeferredLog.h>
+#include <capture_walking/utils/Tracing.h>
 #include <capture_walking/utils/clamp.h>
 
 namespace capture_walking
@@ -42,9 +44,25 @@ namespace capture_walking
   {
   }
 
-  void Stabilizer::addLogEntries(mc_rtc::Logger & logger)
+  void Stabilizer::addChangeLogEntries(ChangeLog & changes)
   {
-    logger.addLogEntry("stabilizer_contact_state",
+    changes.addEntry("stabilizer_gains_com_admittance", [this]() { return comAdmittance_; });
+    changes.addEntry("stabilizer_gains_com_stiffness", [this]() { return comStiffness_; });
+    changes.addEntry("stabilizer_gains_contact_admittance", [this]() { return contactAdmittance_; });
+    changes.addEntry("stabilizer_gains_dcm", [this]() { return dcmGain_; });
+    changes.addEntry("stabilizer_gains_dcmi", [this]() { return dcmIntegralGain_; });
+    changes.addEntry("stabilizer_gains_dfz_admittance", [this]() { return dfzAdmittance_; });
+    changes.addEntry("stabilizer_gains_vdc_frequency", [this]() { return vdcFrequency_; });
+    changes.addEntry("stabilizer_gains_vdc_stiffness", [this]() { return vdcStiffness_; });
+    changes.addEntry("stabilizer_integrator_decay", [this]() { return dcmIntegrator.decay(); });
+    changes.addEntry("stabilizer_qp_weights_compliance", [this]() { return std::pow(qpWeights_.complianceSqrt, 2); });
+    changes.addEntry("stabilizer_qp_weights_net_wrench", [this]() { return std::pow(qpWeights_.netWrenchSqrt, 2); });
+    changes.addEntry("stabilizer_qp_weights_pressure", [this]() { return std::pow(qpWeights_.pressureSqrt, 2); });
+  }
+
+  void Stabilizer::addLogEntries(GroupedLogger & logger)
+  {
+    logger.addLogEntry("stabilizer", "stabilizer_contact_state",
       [this]() -> double
       {
         switch (contactState_)
@@ -59,35 +77,23 @@ namespace capture_walking
             return -3;
         }
       });
-    logger.addLogEntry("stabilizer_distrib_zmp", [this]() { return distribZMP(); });
-    logger.addLogEntry("stabilizer_errors_com", [this]() { return comError_; });
-    logger.addLogEntry("stabilizer_errors_comd", [this]() { return comdError_; });
-    logger.addLogEntry("stabilizer_errors_dcm", [this]() { return dcmError_; });
-    logger.addLogEntry("stabilizer_errors_dcmi", [this]() { return dcmIntegralError_; });
-    logger.addLogEntry("stabilizer_gains_com_admittance", [this]() { return comAdmittance_; });
-    logger.addLogEntry("stabilizer_gains_com_stiffness", [this]() { return comStiffness_; });
-    logger.addLogEntry("stabilizer_gains_contact_admittance", [this]() { return contactAdmittance_; });
-    logger.addLogEntry("stabilizer_gains_dcm", [this]() { return dcmGain_; });
-    logger.addLogEntry("stabilizer_gains_dcmi", [this]() { return dcmIntegralGain_; });
-    logger.addLogEntry("stabilizer_gains_dfz_admittance", [this]() { return dfzAdmittance_; });
-    logger.addLogEntry("stabilizer_gains_vdc_frequency", [this]() { return vdcFrequency_; });
-    logger.addLogEntry("stabilizer_gains_vdc_stiffness", [this]() { return vdcStiffness_; });
-    logger.addLogEntry("stabilizer_integrator_decay", [this]() { return dcmIntegrator.decay(); });
-    logger.addLogEntry("stabilizer_qp_costs_left_ankle", [this]() { return qpLeftAnkleCost_; });
-    logger.addLogEntry("stabilizer_qp_costs_net_wrench", [this]() { return qpNetWrenchCost_; });
-    logger.addLogEntry("stabilizer_qp_costs_pressure_ratio", [this]() { return qpPressureCost_; });
-    logger.addLogEntry("stabilizer_qp_costs_right_ankle", [this]() { return qpRightAnkleCost_; });
-    logger.addLogEntry("stabilizer_qp_weights_compliance", [this]() { return std::pow(qpWeights_.complianceSqrt, 2); });
-    logger.addLogEntry("stabilizer_qp_weights_net_wrench", [this]() { return std::pow(qpWeights_.netWrenchSqrt, 2); });
-    logger.addLogEntry("stabilizer_qp_weights_pressure", [this]() { return std::pow(qpWeights_.pressureSqrt, 2); });
-    logger.addLogEntry("stabilizer_torso_pitch", [this]() { return torsoPitch_; });
-    logger.addLogEntry("stabilizer_vfc_LeftFootVel", [this]() { return logVFCLeftFootVel_; });
-    logger.addLogEntry("stabilizer_vfc_RightFootVel", [this]() { return logVFCRightFootVel_; });
-    logger.addLogEntry("stabilizer_vfc_dfz_measured", [this]() { return logMeasuredDFz_; });
-    logger.addLogEntry("stabilizer_vfc_dfz_target", [this]() { return logTargetDFz_; });
-    logger.addLogEntry("stabilizer_vfc_stz_measured", [this]() { return logMeasuredSTz_; });
-    logger.addLogEntry("stabilizer_vfc_stz_target", [this]() { return logTargetSTz_; });
-    logger.addLogEntry("stabilizer_zmpcc_comdd_offset", [this]() { return zmpccAccelOffset_; });
+    logger.addLogEntry("stabilizer", "stabilizer_distrib_zmp", [this]() { return distribZMP(); });
+    logger.addLogEntry("errors", "stabilizer_errors_com", [this]() { return comError_; });
+    logger.addLogEntry("errors", "stabilizer_errors_comd", [this]() { return comdError_; });
+    logger.addLogEntry("errors", "stabilizer_errors_dcm", [this]() { return dcmError_; });
+    logger.addLogEntry("errors", "stabilizer_errors_dcmi", [this]() { return dcmIntegralError_; });
+    logger.addLogEntry("stabilizer_qp", "stabilizer_qp_costs_left_ankle", [this]() { return qpLeftAnkleCost_; });
+    logger.addLogEntry("stabilizer_qp", "stabilizer_qp_costs_net_wrench", [this]() { return qpNetWrenchCost_; });
+    logger.addLogEntry("stabilizer_qp", "stabilizer_qp_costs_pressure_ratio", [this]() { return qpPressureCost_; });
+    logger.addLogEntry("stabilizer_qp", "stabilizer_qp_costs_right_ankle", [this]() { return qpRightAnkleCost_; });
+    logger.addLogEntry("stabilizer", "stabilizer_torso_pitch", [this]() { return torsoPitch_; });
+    logger.addLogEntry("stabilizer_vfc", "stabilizer_vfc_LeftFootVel", [this]() { return logVFCLeftFootVel_; });
+    logger.addLogEntry("stabilizer_vfc", "stabilizer_vfc_RightFootVel", [this]() { return logVFCRightFootVel_; });
+    logger.addLogEntry("stabilizer_vfc", "stabilizer_vfc_dfz_measured", [this]() { return logMeasuredDFz_; });
+    logger.addLogEntry("stabilizer_vfc", "stabilizer_vfc_dfz_target", [this]() { return logTargetDFz_; });
+    logger.addLogEntry("stabilizer_vfc", "stabilizer_vfc_stz_measured", [this]() { return logMeasuredSTz_; });
+    logger.addLogEntry("stabilizer_vfc", "stabilizer_vfc_stz_target", [this]() { return logTargetSTz_; });
+    logger.addLogEntry("stabilizer", "stabilizer_zmpcc_comdd_offset", [this]() { return zmpccAccelOffset_; });
   }
 
   void Stabilizer::addGUIElements(std::shared_ptr<mc_rtc::gui::StateBuilder> gui)
@@ -266,6 +272,8 @@ namespace capture_walking
     comTask->setGains(comStiffness_, 2 * comStiffness_.cwiseSqrt());
     comTask->weight(comWeight_);
 
+    hasLeftFootContact_ = false;
+    hasRightFootContact_ = false;
     leftFootTask.reset(new mc_tasks::force::CoPTask("LeftFootCenter", robots, robotIndex));
     rightFootTask.reset(new mc_tasks::force::CoPTask("RightFootCenter", robots, robotIndex));
     leftFootTask->maxAngularVel({MAX_FDC_RX_VEL, MAX_FDC_RY_VEL, MAX_FDC_RZ_VEL});
@@ -290,13 +298,13 @@ namespace capture_walking
 
   void Stabilizer::checkGains()
   {
-    clampInPlace(comAdmittance_.x(), 0., MAX_COM_ADMITTANCE_X, "CoM a_x");
-    clampInPlace(comAdmittance_.y(), 0., MAX_COM_ADMITTANCE_Y, "CoM a_y");
-    clampInPlace(contactAdmittance_.couple().x(), 0., MAX_COP_ADMITTANCE_Y, "CoP a_y");
-    clampInPlace(contactAdmittance_.couple().y(), 0., MAX_COP_ADMITTANCE_X, "CoP a_x");
-    clampInPlace(dcmGain_, 0., MAX_DCM_P_GAIN, "DCM k_p");
-    clampInPlace(dcmIntegralGain_, 0., MAX_DCM_I_GAIN, "DCM k_i");
-    clampInPlace(dfzAdmittance_, 0., MAX_DFZ_ADMITTANCE, "DFz a");
+    CW_CLAMP_IN_PLACE(comAdmittance_.x(), 0., MAX_COM_ADMITTANCE_X, "CoM a_x");
+    CW_CLAMP_IN_PLACE(comAdmittance_.y(), 0., MAX_COM_ADMITTANCE_Y, "CoM a_y");
+    CW_CLAMP_IN_PLACE(contactAdmittance_.couple().x(), 0., MAX_COP_ADMITTANCE_Y, "CoP a_y");
+    CW_CLAMP_IN_PLACE(contactAdmittance_.couple().y(), 0., MAX_COP_ADMITTANCE_X, "CoP a_x");
+    CW_CLAMP_IN_PLACE(dcmGain_, 0., MAX_DCM_P_GAIN, "DCM k_p");
+    CW_CLAMP_IN_PLACE(dcmIntegralGain_, 0., MAX_DCM_I_GAIN, "DCM k_i");
+    CW_CLAMP_IN_PLACE(dfzAdmittance_, 0., MAX_DFZ_ADMITTANCE, "DFz a");
   }
 
   void Stabilizer::addTasks(mc_solver::QPSolver & solver)
@@ -319,18 +327,28 @@ namespace capture_walking
 
   void Stabilizer::setContact(std::shared_ptr<mc_tasks::force::CoPTask> footTask, const Contact & contact)
   {
+    bool isLeftFoot = (footTask == leftFootTask);
+    bool & hasContact = (isLeftFoot) ? hasLeftFootContact_ : hasRightFootContact_;
+    const Contact & currentContact = (isLeftFoot) ? leftFootContact : rightFootContact;
+    if (hasContact && currentContact.pose.translation().isApprox(contact.pose.translation(), 1e-9)
+        && currentContact.pose.rotation().isApprox(contact.pose.rotation(), 1e-9))
+    {
+      return;
+    }
     footTask->reset();
     footTask->admittance(contactAdmittance_);
     footTask->setGains(contactStiffness_, contactDamping_);
     footTask->targetPose(contact.pose);
     footTask->weight(contactWeight_);
-    if (footTask->surface() == "LeftFootCenter")
+    if (footTask == leftFootTask)
     {
       leftFootContact = contact;
+      hasLeftFootContact_ = true;
     }
-    else if (footTask->surface() == "RightFootCenter")
+    else if (footTask == rightFootTask)
     {
       rightFootContact = contact;
+      hasRightFootContact_ = true;
     }
     else
     {
@@ -340,6 +358,14 @@ namespace capture_walking
 
   void Stabilizer::setSwingFoot(std::shared_ptr<mc_tasks::force::CoPTask> footTask)
   {
+    if (footTask == leftFootTask)
+    {
+      hasLeftFootContact_ = false;
+    }
+    else if (footTask == rightFootTask)
+    {
+      hasRightFootContact_ = false;
+    }
     footTask->reset();
     footTask->stiffness(swingFootStiffness_); // sets damping as well
     footTask->weight(swingFootWeight_);
@@ -353,7 +379,7 @@ namespace capture_walking
     double xDist = std::abs(X_c_s.translation().x());
     double yDist = std::abs(X_c_s.translation().y());
     double zDist = std::abs(X_c_s.translation().z());
-    double pressure = footTask->measuredWrench().force().z();
+    double pressure = measuredPressure(footTask);
     return (xDist < 0.03 && yDist < 0.03 && zDist < 0.03 && pressure > 50.);
   }
 
@@ -362,10 +388,10 @@ namespace capture_walking
     constexpr double MAX_VEL = 0.01; // [m] / [s]
     constexpr double TOUCHDOWN_PRESSURE = 50.;  // [N]
     constexpr double DESIRED_AFZ = MAX_VEL / TOUCHDOWN_PRESSURE;
-    if (footTask->measuredWrench().force().z() < TOUCHDOWN_PRESSURE)
+    if (measuredPressure(footTask) < TOUCHDOWN_PRESSURE)
     {
       auto a = footTask->admittance();
-      double AFz = clamp(DESIRED_AFZ, 0., 1e-2, "Contact seeking admittance");
+      double AFz = CW_CLAMP(DESIRED_AFZ, 0., 1e-2, "Contact seeking admittance");
       footTask->admittance({a.couple(), {a.force().x(), a.force().y(), AFz}});
       footTask->targetForce({0., 0., TOUCHDOWN_PRESSURE});
     }
@@ -400,6 +426,7 @@ namespace capture_walking
 
   void Stabilizer::run()
   {
+    CW_TRACE_SPAN("Stabilizer::run");
     checkGains();
     setSupportFootGains();
     updatePelvis();
@@ -437,6 +464,7 @@ namespace capture_walking
 
   void Stabilizer::updatePelvis()
   {
+    CW_TRACE_SPAN("Stabilizer::updatePelvis");
     const sva::PTransformd & leftPose = leftFootContact.pose;
     const sva::PTransformd & rightPose = rightFootContact.pose;
     sva::PTransformd target;
@@ -463,6 +491,7 @@ namespace capture_walking
 
   sva::ForceVecd Stabilizer::computeDesiredWrench()
   {
+    CW_TRACE_SPAN("Stabilizer::computeDesiredWrench");
     comError_ = pendulum_.com() - measuredCoM_;
     comdError_ = pendulum_.comd() - measuredCoMd_;
 
@@ -481,6 +510,7 @@ namespace capture_walking
 
   void Stabilizer::distributeWrench(const sva::ForceVecd & desiredWrench)
   {
+    CW_TRACE_SPAN("Stabilizer::distributeWrench");
     // Variables
     // ---------
     // x = [w_l_0 w_r_0] where
@@ -573,7 +603,7 @@ namespace capture_walking
     Eigen::VectorXd x = wrenchSolver_.result();
     if (!solverSuccess)
     {
-      LOG_ERROR("DS force distribution QP failed to run");
+      CW_LOG_ERROR("DS force distribution QP failed to run");
       wrenchSolver_.print_inform();
       return;
     }
@@ -601,6 +631,7 @@ namespace capture_walking
 
   void Stabilizer::saturateWrench(const sva::ForceVecd & desiredWrench, std::shared_ptr<mc_tasks::force::CoPTask> & footTask)
   {
+    CW_TRACE_SPAN("Stabilizer::saturateWrench");
     constexpr unsigned NB_CONS = 16;
     constexpr unsigned NB_VAR = 6;
 
@@ -634,7 +665,7 @@ namespace capture_walking
     Eigen::VectorXd x = wrenchSolver_.result();
     if (wrenchSolver_.inform() != Eigen::lssol::eStatus::STRONG_MINIMUM)
     {
-      LOG_ERROR("SS force distribution QP failed to run");
+      CW_LOG_ERROR("SS force distribution QP failed to run");
       wrenchSolver_.print_inform();
       return;
     }
@@ -717,6 +748,7 @@ namespace capture_walking
 
   void Stabilizer::updateCoMAccelZMPCC()
   {
+    CW_TRACE_SPAN("Stabilizer::updateCoMAccelZMPCC");
     auto measuredZMP = computeOutputFrameZMP(measuredWrench_);
     //auto zmpError = pendulum_.zmp() - measuredZMP; // nope
     auto distribZMP = computeOutputFrameZMP(distribWrench_);
@@ -729,8 +761,9 @@ namespace capture_walking
 
   void Stabilizer::updateFootForceDifferenceControl()
   {
-    double LFz = leftFootTask->measuredWrench().force().z();
-    double RFz = rightFootTask->measuredWrench().force().z();
+    CW_TRACE_SPAN("Stabilizer::updateFootForceDifferenceControl");
+    double LFz = leftFootPressure_;
+    double RFz = rightFootPressure_;
     bool inTheAir = (LFz < MIN_DS_PRESSURE && RFz < MIN_DS_PRESSURE);
     if (contactState_ == ContactState::DoubleSupport && !inTheAir)
     {
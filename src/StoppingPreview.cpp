@@ -0,0 +1,62 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <capture_walking/StoppingPreview.h>
+#include <capture_walking/utils/clamp.h>
+
+namespace capture_walking
+{
+  namespace
+  {
+    constexpr double MIN_STOPPING_COM_HEIGHT = 0.3; // [m]
+    constexpr double STOPPING_ZMP_MARGIN = 0.005; // [m]
+  }
+
+  StoppingPreview::StoppingPreview(const Pendulum & state, const Contact & contact)
+    : contact_(contact)
+  {
+    Eigen::Vector3d n = contact.normal();
+    comHeight_ = std::max(n.dot(state.com() - contact.p()), MIN_STOPPING_COM_HEIGHT);
+    lambda_ = world::GRAVITY / comHeight_;
+    double omega = std::sqrt(lambda_);
+    Eigen::Vector3d comd = state.comd() - n.dot(state.comd()) * n;
+    Eigen::Vector3d capturePoint = state.com() + comd / omega;
+    Eigen::Vector3d offset = capturePoint - contact.p();
+    double maxX = std::max(contact.halfLength - STOPPING_ZMP_MARGIN, 0.);
+    double maxY = std::max(contact.halfWidth - STOPPING_ZMP_MARGIN, 0.);
+    double x = clamp(contact.t().dot(offset), -maxX, maxX);
+    double y = clamp(contact.b().dot(offset), -maxY, maxY);
+    zmp_ = contact.p() + x * contact.t() + y * contact.b();
+  }
+
+  void StoppingPreview::integrate(Pendulum & state, double dt)
+  {
+    state.integrateIPM(zmp_, lambda_, dt);
+    state.resetCoMHeight(comHeight_, contact_); // horizontal dynamics only
+    playbackTime_ += dt;
+  }
+}
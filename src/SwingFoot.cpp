@@ -92,22 +92,13 @@ namespace capture_walking
     updatePose(/* t = */ 0.);
   }
 
-  void SwingFoot::addLogEntries(mc_rtc::Logger & logger)
+  void SwingFoot::addLogEntries(GroupedLogger & logger)
   {
-    logger.addLogEntry("swing_foot_accel", [this]() { return accel(); });
-    logger.addLogEntry("swing_foot_offset", [this]() { return takeoffOffset_; });
-    logger.addLogEntry("swing_foot_pitch", [this]() { return pitch_; });
-    logger.addLogEntry("swing_foot_pose", [this]() { return pose(); });
-    logger.addLogEntry("swing_foot_vel", [this]() { return vel(); });
-  }
-
-  void SwingFoot::removeLogEntries(mc_rtc::Logger & logger)
-  {
-    logger.removeLogEntry("swing_foot_accel");
-    logger.removeLogEntry("swing_foot_offset");
-    logger.removeLogEntry("swing_foot_pitch");
-    logger.removeLogEntry("swing_foot_pose");
-    logger.removeLogEntry("swing_foot_vel");
+    logger.addLogEntry("wpg", "swing_foot_accel", [this]() { return accel(); });
+    logger.addLogEntry("wpg", "swing_foot_offset", [this]() { return takeoffOffset_; });
+    logger.addLogEntry("wpg", "swing_foot_pitch", [this]() { return pitch_; });
+    logger.addLogEntry("wpg", "swing_foot_pose", [this]() { return pose(); });
+    logger.addLogEntry("wpg", "swing_foot_vel", [this]() { return vel(); });
   }
 
   void SwingFoot::integrate(double dt)
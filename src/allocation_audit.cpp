@@ -0,0 +1,115 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** Allocation hook library for the control-loop allocation audit.
+ *
+ * Preload it to count heap allocations per thread:
+ *
+ *     LD_PRELOAD=libcapture_walking_controller_alloc_audit.so <mc_rtc_interface> ...
+ *
+ * All allocation functions forward to the glibc implementation. Since
+ * operator new is implemented on top of malloc, it is counted as well.
+ *
+ */
+
+#include <cerrno>
+#include <cstddef>
+
+#include <capture_walking/utils/AllocationAudit.h>
+
+extern "C"
+{
+  void * __libc_calloc(size_t, size_t);
+  void * __libc_malloc(size_t);
+  void * __libc_memalign(size_t, size_t);
+  void * __libc_realloc(void *, size_t);
+}
+
+namespace
+{
+  __attribute__((tls_model("initial-exec"))) thread_local capture_walking::AllocationCounters counters;
+
+  inline void count(size_t size)
+  {
+    counters.nbAllocations++;
+    counters.nbBytes += size;
+  }
+}
+
+extern "C"
+{
+  const capture_walking::AllocationCounters * cw_thread_allocation_counters()
+  {
+    return &counters;
+  }
+
+  void * malloc(size_t size) noexcept
+  {
+    count(size);
+    return __libc_malloc(size);
+  }
+
+  void * calloc(size_t nmemb, size_t size) noexcept
+  {
+    count(nmemb * size);
+    return __libc_calloc(nmemb, size);
+  }
+
+  void * realloc(void * ptr, size_t size) noexcept
+  {
+    count(size);
+    return __libc_realloc(ptr, size);
+  }
+
+  void * memalign(size_t alignment, size_t size) noexcept
+  {
+    count(size);
+    return __libc_memalign(alignment, size);
+  }
+
+  void * aligned_alloc(size_t alignment, size_t size) noexcept
+  {
+    count(size);
+    return __libc_memalign(alignment, size);
+  }
+
+  int posix_memalign(void ** memptr, size_t alignment, size_t size) noexcept
+  {
+    if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0)
+    {
+      return EINVAL;
+    }
+    count(size);
+    void * ptr = __libc_memalign(alignment, size);
+    if (!ptr)
+    {
+      return ENOMEM;
+    }
+    *memptr = ptr;
+    return 0;
+  }
+}
@@ -25,6 +25,8 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
+
 #include <ros/ros.h>
 
 #include <capture_walking/Controller.h>
@@ -49,6 +51,16 @@ namespace capture_walking
       {'c', {0.0, 0.5, 1.0}},
       {'m', {1.0, 0.0, 0.5}}
     };
+
+    /** Name of the TF frame of a footstep window slot.
+     *
+     * \param i Index of the footstep in the window.
+     *
+     */
+    std::string footstepFrame(unsigned i)
+    {
+      return "footstep_window_" + std::to_string(i);
+    }
   }
 
   visualization_msgs::Marker Controller::getArrowMarker(const std::string & frame_id, const Eigen::Vector3d & from, const Eigen::Vector3d & to, char color, double scale)
@@ -72,42 +84,13 @@ namespace capture_walking
     return m;
   }
 
-  visualization_msgs::Marker Controller::getCoPMarker(const std::string & surfaceName, char color)
-  {
-    const std::shared_ptr<mc_tasks::force::CoPTask> & copTask = (surfaceName == "LeftFootCenter") ? stabilizer_.leftFootTask : stabilizer_.rightFootTask;
-    Eigen::Vector2d cop_ = copTask->measuredCoP();
-    Eigen::Vector3d cop(cop_(0), cop_(1), 0.);
-    visualization_msgs::Marker m;
-    m.type = visualization_msgs::Marker::SPHERE;
-    m.action = visualization_msgs::Marker::ADD;
-    m.pose.position.x = cop(0);
-    m.pose.position.y = cop(1);
-    m.pose.position.z = cop(2);
-    m.scale.x = 0.02;
-    m.scale.y = 0.02;
-    m.scale.z = 0.02;
-    m.color.a = 1.0;
-    m.color.r = COLORS.at(color)[0];
-    m.color.g = COLORS.at(color)[1];
-    m.color.b = COLORS.at(color)[2];
-    m.header.stamp = ros::Time();
-    m.header.frame_id = "control/surfaces/" + surfaceName;
-    m.id = nextMarkerId_++;
-    m.lifetime = ros::Duration(MARKER_LIFETIME);
-    return m;
-  }
-
-  visualization_msgs::Marker Controller::getForceMarker(const std::string & surfaceName, char color)
+  visualization_msgs::Marker Controller::getForceMarker(const std::string & frame_id, const VisualizationSnapshot::Foot & foot, char color)
   {
-    const std::shared_ptr<mc_tasks::force::CoPTask> & copTask = (surfaceName == "LeftFootCenter") ? stabilizer_.leftFootTask : stabilizer_.rightFootTask;
-    Eigen::Vector2d cop_ = copTask->measuredCoP();
-    Eigen::Vector3d cop(cop_(0), cop_(1), 0.);
-    Eigen::Vector3d force = copTask->measuredWrench().force();
     visualization_msgs::Marker m;
     m.type = visualization_msgs::Marker::ARROW;
     m.action = visualization_msgs::Marker::ADD;
-    m.points.push_back(rosPoint(cop));
-    m.points.push_back(rosPoint(cop + FORCE_SCALE * force));
+    m.points.push_back(rosPoint(foot.measuredCoP));
+    m.points.push_back(rosPoint(foot.measuredCoP + FORCE_SCALE * foot.force));
     m.scale.x = ARROW_SHAFT_DIAM;
     m.scale.y = ARROW_HEAD_DIAM;
     m.scale.z = ARROW_HEAD_LEN;
@@ -116,18 +99,12 @@ namespace capture_walking
     m.color.g = COLORS.at(color)[1];
     m.color.b = COLORS.at(color)[2];
     m.header.stamp = ros::Time();
-    m.header.frame_id = "control/surfaces/" + surfaceName;
+    m.header.frame_id = frame_id;
     m.id = nextMarkerId_++;
     m.lifetime = ros::Duration(MARKER_LIFETIME);
     return m;
   }
 
-  visualization_msgs::Marker Controller::getPointMarker(const std::string & frame_id, const Eigen::Vector2d & pos, char color, double scale)
-  {
-    Eigen::Vector3d pos3D(pos(0), pos(1), 0.);
-    return getPointMarker(frame_id, pos3D, color, scale);
-  }
-
   visualization_msgs::Marker Controller::getPointMarker(const std::string & frame_id, const Eigen::Vector3d & pos, char color, double scale)
   {
     visualization_msgs::Marker m;
@@ -150,16 +127,18 @@ namespace capture_walking
     return m;
   }
 
-  visualization_msgs::Marker Controller::getContactMarker(const std::string & frame_id, char color)
+  visualization_msgs::Marker Controller::getContactMarker(const std::string & frame_id, const FootstepWindow & window, char color)
   {
+    const double halfLength = window.soleHalfLength;
+    const double halfWidth = window.soleHalfWidth;
     visualization_msgs::Marker m;
     m.type = visualization_msgs::Marker::LINE_STRIP;
     m.action = visualization_msgs::Marker::ADD;
-    m.points.push_back(rosPoint(Eigen::Vector3d(+sole.halfLength, +sole.halfWidth, 0.)));
-    m.points.push_back(rosPoint(Eigen::Vector3d(+sole.halfLength, -sole.halfWidth, 0.)));
-    m.points.push_back(rosPoint(Eigen::Vector3d(-sole.halfLength, -sole.halfWidth, 0.)));
-    m.points.push_back(rosPoint(Eigen::Vector3d(-sole.halfLength, +sole.halfWidth, 0.)));
-    m.points.push_back(rosPoint(Eigen::Vector3d(+sole.halfLength, +sole.halfWidth, 0.)));
+    m.points.push_back(rosPoint(Eigen::Vector3d(+halfLength, +halfWidth, 0.)));
+    m.points.push_back(rosPoint(Eigen::Vector3d(+halfLength, -halfWidth, 0.)));
+    m.points.push_back(rosPoint(Eigen::Vector3d(-halfLength, -halfWidth, 0.)));
+    m.points.push_back(rosPoint(Eigen::Vector3d(-halfLength, +halfWidth, 0.)));
+    m.points.push_back(rosPoint(Eigen::Vector3d(+halfLength, +halfWidth, 0.)));
     m.scale.x = 0.005;
     m.color.a = 1.0;
     m.color.r = COLORS.at(color)[0];
@@ -168,102 +147,197 @@ namespace capture_walking
     m.header.stamp = ros::Time();
     m.header.frame_id = frame_id;
     m.id = nextMarkerId_++;
-    m.lifetime = ros::Duration(MARKER_LIFETIME);
+    m.lifetime = ros::Duration(); // contact markers are latched until the next window
     return m;
   }
 
-  visualization_msgs::MarkerArray Controller::getPendulumMarkerArray(const Pendulum & state, char color)
+  visualization_msgs::MarkerArray Controller::getFootstepMarkerArray(const FootstepWindow & window)
   {
     visualization_msgs::MarkerArray array;
+    visualization_msgs::Marker clear;
+    clear.action = visualization_msgs::Marker::DELETEALL;
+    clear.header.frame_id = "robot_map";
+    array.markers.push_back(clear);
     nextMarkerId_ = 0;
-    array.markers.push_back(getArrowMarker("robot_map", state.zmp(), state.com(), color, 0.1));
-    array.markers.push_back(getArrowMarker("robot_map", state.zmp(), state.zmp() + FORCE_SCALE * pendulumObserver_.contactForce(state), color));
-    array.markers.push_back(getPointMarker("robot_map", state.com(), color));
-    array.markers.push_back(getPointMarker("robot_map", state.zmp(), color));
+    for (unsigned i = 0; i < window.nbFootsteps; i++)
+    {
+      const Eigen::Vector3d & p = window.poses[i].translation();
+      double supportDist = (p - window.supportPose.translation()).norm();
+      double targetDist = (p - window.targetPose.translation()).norm();
+      constexpr double SAME_CONTACT_DIST = 0.005;
+      if (supportDist > SAME_CONTACT_DIST && targetDist > SAME_CONTACT_DIST)
+      {
+        array.markers.push_back(getContactMarker(footstepFrame(i), window, 'b'));
+      }
+    }
+    array.markers.push_back(getContactMarker("support_contact", window, 'g'));
+    array.markers.push_back(getContactMarker("target_contact", window, 'r'));
     return array;
   }
 
-  void Controller::publishMarkers()
+  visualization_msgs::MarkerArray Controller::getPendulumMarkerArray(const VisualizationSnapshot::Pendulum & state, char color)
   {
-    Eigen::Vector3d controlDcm_ = controlCom_ + controlComd_ / pendulum().omega();
-    Eigen::Vector3d realDcm_ = realCom_ + realComd_ / pendulum().omega();
-
+    visualization_msgs::MarkerArray array;
     nextMarkerId_ = 0;
-    visualization_msgs::MarkerArray sensorArray;
-    sensorArray.markers.push_back(getCoPMarker("LeftFootCenter", 'g'));
-    sensorArray.markers.push_back(getForceMarker("LeftFootCenter", 'g'));
-    sensorArray.markers.push_back(getCoPMarker("RightFootCenter", 'g'));
-    sensorArray.markers.push_back(getForceMarker("RightFootCenter", 'g'));
-    sensorPublisher_.publish(sensorArray);
+    array.markers.push_back(getArrowMarker("robot_map", state.zmp, state.com, color, 0.1));
+    array.markers.push_back(getArrowMarker("robot_map", state.zmp, state.zmp + FORCE_SCALE * state.contactForce, color));
+    array.markers.push_back(getPointMarker("robot_map", state.com, color));
+    array.markers.push_back(getPointMarker("robot_map", state.zmp, color));
+    return array;
+  }
 
-    nextMarkerId_ = 0;
-    visualization_msgs::MarkerArray extraArray;
-    extraArray.markers.push_back(getArrowMarker("robot_map", controlCom_, controlDcm_, 'b', 0.2));
-    extraArray.markers.push_back(getPointMarker("robot_map", controlCom_, 'b'));
-    extraArray.markers.push_back(getPointMarker("robot_map", controlDcm_, 'b', 0.5));
-    extraArray.markers.push_back(getArrowMarker("robot_map", realCom_, realDcm_, 'g', 0.2));
-    extraArray.markers.push_back(getPointMarker("robot_map", realCom_, 'g'));
-    extraArray.markers.push_back(getPointMarker("robot_map", realDcm_, 'g', 0.5));
-    extraArray.markers.push_back(getPointMarker("control/surfaces/LeftFootCenter", stabilizer_.leftFootTask->targetCoP(), 'm', 0.5));
-    extraArray.markers.push_back(getPointMarker("control/surfaces/RightFootCenter", stabilizer_.rightFootTask->targetCoP(), 'm', 0.5));
-    extraArray.markers.push_back(getPointMarker("robot_map", stabilizer_.distribZMP(), 'm'));
-    extraPublisher_.publish(extraArray);
+  void Controller::publishMarkers(const VisualizationSnapshot & snapshot)
+  {
+    if (sensorPublisher_.getNumSubscribers() > 0)
+    {
+      nextMarkerId_ = 0;
+      visualization_msgs::MarkerArray sensorArray;
+      sensorArray.markers.push_back(getPointMarker("control/surfaces/LeftFootCenter", snapshot.leftFoot.measuredCoP, 'g'));
+      sensorArray.markers.push_back(getForceMarker("control/surfaces/LeftFootCenter", snapshot.leftFoot, 'g'));
+      sensorArray.markers.push_back(getPointMarker("control/surfaces/RightFootCenter", snapshot.rightFoot.measuredCoP, 'g'));
+      sensorArray.markers.push_back(getForceMarker("control/surfaces/RightFootCenter", snapshot.rightFoot, 'g'));
+      sensorPublisher_.publish(sensorArray);
+    }
 
-    pendulumObserverPublisher_.publish(getPendulumMarkerArray(pendulumObserver_, 'r'));
-    pendulumPublisher_.publish(getPendulumMarkerArray(pendulum_, 'y'));
+    if (extraPublisher_.getNumSubscribers() > 0)
+    {
+      nextMarkerId_ = 0;
+      visualization_msgs::MarkerArray extraArray;
+      extraArray.markers.push_back(getArrowMarker("robot_map", snapshot.controlCom, snapshot.controlDcm, 'b', 0.2));
+      extraArray.markers.push_back(getPointMarker("robot_map", snapshot.controlCom, 'b'));
+      extraArray.markers.push_back(getPointMarker("robot_map", snapshot.controlDcm, 'b', 0.5));
+      extraArray.markers.push_back(getArrowMarker("robot_map", snapshot.realCom, snapshot.realDcm, 'g', 0.2));
+      extraArray.markers.push_back(getPointMarker("robot_map", snapshot.realCom, 'g'));
+      extraArray.markers.push_back(getPointMarker("robot_map", snapshot.realDcm, 'g', 0.5));
+      extraArray.markers.push_back(getPointMarker("control/surfaces/LeftFootCenter", snapshot.leftFoot.targetCoP, 'm', 0.5));
+      extraArray.markers.push_back(getPointMarker("control/surfaces/RightFootCenter", snapshot.rightFoot.targetCoP, 'm', 0.5));
+      extraArray.markers.push_back(getPointMarker("robot_map", snapshot.distribZMP, 'm'));
+      extraPublisher_.publish(extraArray);
+    }
 
-    nextMarkerId_ = 0;
-    visualization_msgs::MarkerArray footstepArray;
-    const auto & contacts = plan.contacts();
-    for (unsigned i = 0; i < contacts.size(); i++)
+    if (pendulumObserverPublisher_.getNumSubscribers() > 0)
     {
-      auto & contact = contacts[i];
-      double supportDist = (contact.p() - supportContact().p()).norm();
-      double targetDist = (contact.p() - targetContact().p()).norm();
-      constexpr double SAME_CONTACT_DIST = 0.005;
-      if (supportDist > SAME_CONTACT_DIST && targetDist > SAME_CONTACT_DIST)
+      pendulumObserverPublisher_.publish(getPendulumMarkerArray(snapshot.pendulumObserver, 'r'));
+    }
+    if (pendulumPublisher_.getNumSubscribers() > 0)
+    {
+      pendulumPublisher_.publish(getPendulumMarkerArray(snapshot.pendulum, 'y'));
+    }
+  }
+
+  void Controller::publishSnapshot()
+  {
+    auto fillFoot = [](VisualizationSnapshot::Foot & foot, const mc_tasks::force::CoPTask & copTask, const SensorFrame::Foot & sensor)
+    {
+      const Eigen::Vector2d & targetCoP = copTask.targetCoP();
+      foot.force = sensor.surfaceWrench.force();
+      foot.measuredCoP = Eigen::Vector3d{sensor.cop.x(), sensor.cop.y(), 0.};
+      foot.targetCoP = Eigen::Vector3d{targetCoP.x(), targetCoP.y(), 0.};
+    };
+    auto fillPendulum = [this](VisualizationSnapshot::Pendulum & snap, const Pendulum & state)
+    {
+      snap.com = state.com();
+      snap.contactForce = pendulumObserver_.contactForce(state);
+      snap.zmp = state.zmp();
+    };
+
+    VisualizationSnapshot & snapshot = snapshot_.write();
+    double omega = pendulum_.omega();
+    snapshot.controlCom = controlCom_;
+    snapshot.controlDcm = controlCom_ + controlComd_ / omega;
+    snapshot.distribZMP = stabilizer_.distribZMP();
+    snapshot.realCom = realCom_;
+    snapshot.realDcm = realCom_ + realComd_ / omega;
+    fillFoot(snapshot.leftFoot, *stabilizer_.leftFootTask, sensorFrame_.leftFoot);
+    fillFoot(snapshot.rightFoot, *stabilizer_.rightFootTask, sensorFrame_.rightFoot);
+    fillPendulum(snapshot.pendulum, pendulum_);
+    fillPendulum(snapshot.pendulumObserver, pendulumObserver_);
+
+    const sva::PTransformd & X_0_base = robot().bodyPosW("base_link");
+    snapshot.X_0_inertial = sva::PTransformd(sensorFrame_.imuOrientation, X_0_base.translation());
+    snapshot.supportPose = supportContact().pose;
+    snapshot.targetPose = targetContact().pose;
+    snapshot_.publish();
+
+    if (plan.version() != footstepWindowVersion_)
+    {
+      FootstepWindow & window = footstepWindow_.write();
+      unsigned targetIndex = (plan.nextFootstep() > 0) ? plan.nextFootstep() - 1 : 0;
+      window.firstIndex = (targetIndex > FOOTSTEP_WINDOW_BEHIND) ? targetIndex - FOOTSTEP_WINDOW_BEHIND : 0;
+      window.firstIndex = std::max(window.firstIndex, plan.firstIndex());
+      window.nbFootsteps = 0;
+      for (unsigned i = window.firstIndex; i < plan.endIndex() && window.nbFootsteps < FOOTSTEP_WINDOW_SIZE; i++)
       {
-        footstepArray.markers.push_back(getContactMarker("footstep_" + std::to_string(i), 'b'));
+        window.poses[window.nbFootsteps++] = plan.contactPose(i);
       }
+      window.soleHalfLength = sole.halfLength;
+      window.soleHalfWidth = sole.halfWidth;
+      window.supportPose = supportContact().pose;
+      window.targetPose = targetContact().pose;
+      footstepWindow_.publish();
+      footstepWindowVersion_ = plan.version();
     }
-    footstepArray.markers.push_back(getContactMarker("support_contact", 'g'));
-    footstepArray.markers.push_back(getContactMarker("target_contact", 'r'));
-    footstepPublisher_.publish(footstepArray);
   }
 
-  void Controller::publishTransforms()
+  void Controller::publishFootstepTransforms(const FootstepWindow & window)
   {
     ros::Time tm = ros::Time::now();
     std::vector<geometry_msgs::TransformStamped> transforms;
-    const sva::PTransformd & X_0_base = robot().bodyPosW("base_link");
-    sva::PTransformd X_0_inertial(robot().bodySensor().orientation().matrix(), X_0_base.translation());
-    transforms.push_back(PT2TF(X_0_inertial, tm, std::string("robot_map"), "inertial", rosSeq_));
-    transforms.push_back(PT2TF(supportContact().pose, tm, std::string("robot_map"), "support_contact", rosSeq_));
-    transforms.push_back(PT2TF(targetContact().pose, tm, std::string("robot_map"), "target_contact", rosSeq_));
-    const auto & contacts = plan.contacts();
-    for (unsigned i = 0; i < contacts.size(); i++)
+    for (unsigned i = 0; i < window.nbFootsteps; i++)
     {
-      transforms.push_back(PT2TF(contacts[i].pose, tm, std::string("robot_map"), "footstep_" + std::to_string(i), rosSeq_));
+      transforms.push_back(PT2TF(window.poses[i], tm, std::string("robot_map"), footstepFrame(i), rosSeq_));
     }
     tfBroadcaster_->sendTransform(transforms);
   }
 
+  void Controller::publishTransforms(const VisualizationSnapshot & snapshot)
+  {
+    ros::Time tm = ros::Time::now();
+    std::vector<geometry_msgs::TransformStamped> transforms;
+    transforms.push_back(PT2TF(snapshot.X_0_inertial, tm, std::string("robot_map"), "inertial", rosSeq_));
+    transforms.push_back(PT2TF(snapshot.supportPose, tm, std::string("robot_map"), "support_contact", rosSeq_));
+    transforms.push_back(PT2TF(snapshot.targetPose, tm, std::string("robot_map"), "target_contact", rosSeq_));
+    tfBroadcaster_->sendTransform(transforms);
+  }
+
   void Controller::spinner()
   {
     const auto & nodeHandle = mc_rtc::ROSBridge::get_node_handle();
 
     pendulumObserverPublisher_ = nodeHandle->advertise<visualization_msgs::MarkerArray>("/capture_walking/PendulumObserver", 1);
     extraPublisher_ = nodeHandle->advertise<visualization_msgs::MarkerArray>("/capture_walking/ExtraMarkers", 1);
-    footstepPublisher_ = nodeHandle->advertise<visualization_msgs::MarkerArray>("/capture_walking/FootstepMarkers", 1);
+    footstepPublisher_ = nodeHandle->advertise<visualization_msgs::MarkerArray>("/capture_walking/FootstepMarkers", 1, /* latch = */ true);
     pendulumPublisher_ = nodeHandle->advertise<visualization_msgs::MarkerArray>("/capture_walking/PendulumReference", 1);
     sensorPublisher_ = nodeHandle->advertise<visualization_msgs::MarkerArray>("/capture_walking/FootForceSensors", 1);
     tfBroadcaster_ = std::unique_ptr<tf2_ros::TransformBroadcaster>(new tf2_ros::TransformBroadcaster());
 
+    bool hasSnapshot = false;
+    bool footstepMarkersOutdated = false;
+    bool hasFootstepWindow = false;
     ros::Rate rate(200);
     while(ros::ok())
     {
-      publishMarkers();
-      publishTransforms();
+      if (footstepWindow_.update())
+      {
+        footstepMarkersOutdated = true;
+        hasFootstepWindow = true;
+      }
+      if (hasFootstepWindow)
+      {
+        publishFootstepTransforms(footstepWindow_.read());
+      }
+      if (footstepMarkersOutdated && footstepPublisher_.getNumSubscribers() > 0)
+      {
+        footstepPublisher_.publish(getFootstepMarkerArray(footstepWindow_.read()));
+        footstepMarkersOutdated = false;
+      }
+      hasSnapshot = snapshot_.update() || hasSnapshot;
+      if (hasSnapshot)
+      {
+        const VisualizationSnapshot & snapshot = snapshot_.read();
+        publishMarkers(snapshot);
+        publishTransforms(snapshot);
+      }
       ros::spinOnce();
       rate.sleep();
       rosSeq_++;
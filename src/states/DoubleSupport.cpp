@@ -25,6 +25,8 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <limits>
+
 #include "DoubleSupport.h"
 
 namespace capture_walking
@@ -37,25 +39,31 @@ namespace capture_walking
     initLeftFootRatio_ = ctl.leftFootRatio();
     remTime_ = duration_;
     stateTime_ = 0.;
-    stopDuringThisDSP_ = ctl.pauseWalking || ctl.prevContact().pauseAfterSwing;
-    timeSinceLastPreviewUpdate_ = 2 * ctl.previewUpdatePeriod; // update at transition
+    stopDuringThisDSP_ = ctl.isPauseRequested(); // called before goToNextFootstep
+    isStarved_ = false;
+    timeSinceLastPreviewUpdate_ = std::numeric_limits<double>::infinity(); // update at transition
 
-    const std::string & targetSurfaceName = ctl.targetContact().surfaceName;
+    const std::string targetSurfaceName = ctl.targetContact().surfaceName();
     auto actualTargetPose = ctl.controlRobot().surfacePose(targetSurfaceName);
     ctl.plan.goToNextFootstep(actualTargetPose);
     if (ctl.isLastDSP()) // called after goToNextFootstep
     {
+      isStarved_ = ctl.plan.isStreaming() && !stopDuringThisDSP_;
       stopDuringThisDSP_ = true;
     }
+    if (ctl.installPresolvedPreview(duration_, stopDuringThisDSP_))
+    {
+      timeSinceLastPreviewUpdate_ = 0.; // solved during single support
+    }
 
     stabilizer().contactState(ContactState::DoubleSupport);
-    if (ctl.prevContact().surfaceName == "LeftFootCenter")
+    if (ctl.prevContact().surface == ContactSurface::LeftFootCenter)
     {
       stabilizer().setContact(stabilizer().leftFootTask, ctl.prevContact());
       stabilizer().setContact(stabilizer().rightFootTask, ctl.supportContact());
       targetLeftFootRatio_ = 0.;
     }
-    else // (ctl.prevContact().surfaceName == "RightFootCenter")
+    else // (ctl.prevContact().surface == ContactSurface::RightFootCenter)
     {
       stabilizer().setContact(stabilizer().leftFootTask, ctl.supportContact());
       stabilizer().setContact(stabilizer().rightFootTask, ctl.prevContact());
@@ -65,16 +73,7 @@ namespace capture_walking
     {
       targetLeftFootRatio_ = 0.5;
     }
-    stabilizer().addTasks(ctl.solver());
-
-    logger().addLogEntry("rem_phase_time", [this]() { return remTime_; });
-    logger().addLogEntry("support_xmax", [&ctl]() { return std::max(ctl.prevContact().xmax(), ctl.supportContact().xmax()); });
-    logger().addLogEntry("support_xmin", [&ctl]() { return std::min(ctl.prevContact().xmin(), ctl.supportContact().xmin()); });
-    logger().addLogEntry("support_ymax", [&ctl]() { return std::max(ctl.prevContact().ymax(), ctl.supportContact().ymax()); });
-    logger().addLogEntry("support_ymin", [&ctl]() { return std::min(ctl.prevContact().ymin(), ctl.supportContact().ymin()); });
-    logger().addLogEntry("support_zmax", [&ctl]() { return std::max(ctl.prevContact().zmax(), ctl.supportContact().zmax()); });
-    logger().addLogEntry("support_zmin", [&ctl]() { return std::min(ctl.prevContact().zmin(), ctl.supportContact().zmin()); });
-    logger().addLogEntry("walking_phase", []() { return 2.; });
+    ctl.addStabilizerTasks();
 
     if (stopDuringThisDSP_)
     {
@@ -86,16 +85,6 @@ namespace capture_walking
 
   void states::DoubleSupport::teardown()
   {
-    stabilizer().removeTasks(controller().solver());
-
-    logger().removeLogEntry("rem_phase_time");
-    logger().removeLogEntry("support_xmax");
-    logger().removeLogEntry("support_xmin");
-    logger().removeLogEntry("support_ymax");
-    logger().removeLogEntry("support_ymin");
-    logger().removeLogEntry("support_zmax");
-    logger().removeLogEntry("support_zmin");
-    logger().removeLogEntry("walking_phase");
   }
 
   void states::DoubleSupport::runState()
@@ -103,7 +92,11 @@ namespace capture_walking
     auto & ctl = controller();
     double dt = ctl.timeStep;
 
-    if (remTime_ > 0 && timeSinceLastPreviewUpdate_ >  ctl.previewUpdatePeriod &&
+    if (isStarved_ && !ctl.isLastDSP() && remTime_ > ctl.previewUpdatePeriod)
+    {
+      resumeWalking();
+    }
+    if (remTime_ > 0 && ctl.previewUpdateRequired(timeSinceLastPreviewUpdate_) &&
         !(stopDuringThisDSP_ && remTime_ < ctl.previewUpdatePeriod))
     {
       updatePreview();
@@ -115,10 +108,13 @@ namespace capture_walking
     ctl.preview->integrate(pendulum(), dt);
     if (ctl.wpg == WalkingPatternGeneration::HorizontalMPC)
     {
-      pendulum().completeIPM(ctl.prevContact());
       pendulum().resetCoMHeight(ctl.plan.comHeight(), ctl.prevContact());
+      pendulum().completeIPM(ctl.prevContact());
+    }
+    {
+      CycleBudget::ScopedSection section(ctl.cycleBudget, CycleSection::Stabilizer);
+      stabilizer().run();
     }
-    stabilizer().run();
 
     remTime_ -= dt;
     stateTime_ += dt;
@@ -135,16 +131,33 @@ namespace capture_walking
     }
     if (stopDuringThisDSP_ && remTime_ < -0.5)
     {
-      if (!ctl.isLastDSP())
+      if (!ctl.isLastDSP() || ctl.plan.isStreaming())
       {
         ctl.plan.restorePreviousFootstep(); // current one is for next SSP
       }
+      ctl.waitForFootsteps = isStarved_;
       output("Standing");
       return true;
     }
     return false;
   }
 
+  void states::DoubleSupport::resumeWalking()
+  {
+    auto & ctl = controller();
+    stopDuringThisDSP_ = false;
+    timeSinceLastPreviewUpdate_ = std::numeric_limits<double>::infinity();
+    updatePreview();
+    if (timeSinceLastPreviewUpdate_ > 0.)
+    {
+      stopDuringThisDSP_ = true; // try again at next cycle
+      return;
+    }
+    isStarved_ = false;
+    targetLeftFootRatio_ = (ctl.prevContact().surface == ContactSurface::LeftFootCenter) ? 0. : 1.;
+    CW_LOG_INFO("Resuming walking on streamed footstep {}", ctl.targetContact().id);
+  }
+
   void states::DoubleSupport::updatePreview()
   {
     switch (controller().wpg)
@@ -62,6 +62,28 @@ namespace capture_walking
        */
       void runState() override;
 
+      /** Walking phase of this state.
+       *
+       */
+      WalkingPhase phase() const override
+      {
+        return WalkingPhase::DoubleSupport;
+      }
+
+      /** Remaining time in the phase.
+       *
+       */
+      double remPhaseTime() const override
+      {
+        return remTime_;
+      }
+
+      /** Resume walking from the final DSP of a streaming plan that
+       * received new contacts.
+       *
+       */
+      void resumeWalking();
+
       /** Update MPC preview.
        *
        */
@@ -78,6 +100,7 @@ namespace capture_walking
       void updatePreviewCPS();
 
     private:
+      bool isStarved_;
       bool stopDuringThisDSP_;
       double duration_;
       double initLeftFootRatio_;
@@ -33,6 +33,16 @@ namespace capture_walking
   {
     constexpr double MAX_ROBOT_MASS = 42.; // [kg]
     constexpr double MIN_ROBOT_MASS = 35.; // [kg]
+
+    /** Get Initial state if it is the active one, nullptr otherwise.
+     *
+     * \param ctl Controller.
+     *
+     */
+    states::Initial * activeInitial(Controller & ctl)
+    {
+      return dynamic_cast<states::Initial*>(ctl.activeState());
+    }
   }
 
   void states::Initial::start()
@@ -43,52 +53,66 @@ namespace capture_walking
     massEstimator_.reset();
     pleaseReWeigh_ = false;
     postureTaskIsActive_ = true;
-    startStandingButton_ = false;
     startStanding_ = false;
 
+    ctl.removeStabilizerTasks();
     ctl.loadFootstepPlan(ctl.plan.name); // reload in case it was updated
     ctl.internalReset();
 
-    logger().addLogEntry("walking_phase", []() { return -2.; });
+    runState(); // don't wait till next cycle to update reference and tasks
+  }
 
-    if (gui())
+  void states::Initial::addGUIElements()
+  {
+    if (!gui())
     {
-      using namespace mc_rtc::gui;
-      gui()->removeElement({"Walking", "Controller"}, "Go back to standing");
-      gui()->removeElement({"Walking", "Controller"}, "Pause walking");
-      gui()->addElement(
-        {"Walking", "Controller"},
-        Button(
-          "Weigh robot",
-          [this]()
+      return;
+    }
+    using namespace mc_rtc::gui;
+    auto & ctl = controller();
+    gui()->addElement(
+      {"Walking", "Controller"},
+      Button(
+        "Weigh robot",
+        [&ctl]()
+        {
+          states::Initial * initial = activeInitial(ctl);
+          if (!initial)
           {
-            massEstimator_.reset();
-            isWeighing_ = true;
-            pleaseReWeigh_ = false;
-          }),
-        ComboInput("Footstep plan",
-          ctl.availablePlans(),
-          [&ctl]() { return ctl.plan.name; },
-          [&ctl](const std::string & name)
+            LOG_WARNING("Robot can only be weighed from the Initial state");
+            return;
+          }
+          initial->startWeighing();
+        }),
+      ComboInput("Footstep plan",
+        ctl.availablePlans(),
+        [&ctl]() { return ctl.plan.name; },
+        [&ctl](const std::string & name)
+        {
+          if (!activeInitial(ctl))
           {
-            ctl.loadFootstepPlan(name);
-            ctl.internalReset();
-          }));
-    }
-
-    runState(); // don't wait till next cycle to update reference and tasks
+            LOG_WARNING("Footstep plan can only be changed from the Initial state");
+            return;
+          }
+          ctl.loadFootstepPlan(name);
+          ctl.internalReset();
+        }),
+      Button(
+        "Start standing",
+        [&ctl]()
+        {
+          states::Initial * initial = activeInitial(ctl);
+          if (!initial)
+          {
+            LOG_WARNING("Robot is already standing");
+            return;
+          }
+          initial->startStanding();
+        }));
   }
 
   void states::Initial::teardown()
   {
-    logger().removeLogEntry("walking_phase");
-
-    if (gui())
-    {
-      gui()->removeElement({"Walking", "Controller"}, "Footstep plan");
-      gui()->removeElement({"Walking", "Controller"}, "Weigh robot");
-      hideStartStandingButton();
-    }
   }
 
   void states::Initial::runState()
@@ -98,26 +122,20 @@ namespace capture_walking
     if (postureTaskIsActive_)
     {
       ctl.internalReset();
-      hideStartStandingButton();
     }
     else if (isWeighing_)
     {
       weighRobot();
-      hideStartStandingButton();
     }
-    else if (pleaseReWeigh_)
+    else if (ctl.isWarmingUp())
     {
-      hideStartStandingButton();
-    }
-    else
-    {
-      showStartStandingButton();
+      ctl.runWarmUp();
     }
   }
 
   bool states::Initial::checkTransitions()
   {
-    if (startStanding_ && !postureTaskIsActive_ && !isWeighing_)
+    if (startStanding_ && !postureTaskIsActive_ && !isWeighing_ && !controller().isWarmingUp())
     {
       output("Standing");
       return true;
@@ -128,8 +146,8 @@ namespace capture_walking
   void states::Initial::weighRobot()
   {
     auto & ctl = controller();
-    double LFz = ctl.stabilizer().leftFootTask->measuredWrench().force().z();
-    double RFz = ctl.stabilizer().rightFootTask->measuredWrench().force().z();
+    double LFz = ctl.sensorFrame().leftFoot.pressure;
+    double RFz = ctl.sensorFrame().rightFoot.pressure;
     massEstimator_.add((LFz + RFz) / world::GRAVITY);
     if (massEstimator_.n() > 100)
     {
@@ -141,30 +159,32 @@ namespace capture_walking
       else
       {
         ctl.updateRobotMass(massEstimator_.avg());
+        ctl.startWarmUp(); // robot is idle, and walking needs its mass
       }
       isWeighing_ = false;
     }
   }
 
-  void states::Initial::showStartStandingButton()
+  void states::Initial::startWeighing()
   {
-    if (!startStandingButton_ && gui())
-    {
-      using namespace mc_rtc::gui;
-      gui()->addElement(
-        {"Walking", "Controller"},
-        Button("Start standing", [this]() { startStanding_ = true; }));
-      startStandingButton_ = true;
-    }
+    massEstimator_.reset();
+    isWeighing_ = true;
+    pleaseReWeigh_ = false;
   }
 
-  void states::Initial::hideStartStandingButton()
+  void states::Initial::startStanding()
   {
-    if (startStandingButton_ && gui())
+    if (postureTaskIsActive_ || isWeighing_)
+    {
+      LOG_WARNING("Wait for the posture task to converge and the robot to be weighed");
+      return;
+    }
+    if (pleaseReWeigh_)
     {
-      gui()->removeElement({"Walking", "Controller"}, "Start standing");
-      startStandingButton_ = false;
+      LOG_ERROR("Robot mass is invalid, weigh the robot again before standing");
+      return;
     }
+    startStanding_ = true;
   }
 }
 
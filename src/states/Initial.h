@@ -50,6 +50,11 @@ namespace capture_walking
        */
       void start() override;
 
+      /** Add weighing, footstep plan and "Start standing" GUI elements.
+       *
+       */
+      void addGUIElements() override;
+
       /** Teardown state.
        *
        */
@@ -65,6 +70,14 @@ namespace capture_walking
        */
       void runState() override;
 
+      /** Walking phase of this state.
+       *
+       */
+      WalkingPhase phase() const override
+      {
+        return WalkingPhase::Initial;
+      }
+
       /** Weigh robot based on force sensor readings. 
        *
        * Assumes the robot is standing still in double support on a flat
@@ -72,22 +85,21 @@ namespace capture_walking
        */
       void weighRobot();
 
-      /** Add "Start standing" transition button to GUI.
+      /** Reset mass estimation and weigh the robot again.
        *
        */
-      void showStartStandingButton();
+      void startWeighing();
 
-      /** Remove "Start standing" transition button from GUI.
+      /** Request transition to standing once the robot is ready.
        *
        */
-      void hideStartStandingButton();
+      void startStanding();
 
     private:
       AvgStdEstimator massEstimator_;
       bool isWeighing_;
       bool pleaseReWeigh_;
       bool postureTaskIsActive_;
-      bool startStandingButton_;
       bool startStanding_;
     };
   }
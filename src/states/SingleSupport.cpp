@@ -38,18 +38,19 @@ namespace capture_walking
     earlyDoubleSupportDuration_ = 0.;
     duration_ = ctl.singleSupportDuration();
     hasUpdatedMPCOnce_ = false;
+    hasRequestedPresolve_ = false;
     remTime_ = ctl.singleSupportDuration();
     stateTime_ = 0.;
     timeSinceLastPreviewUpdate_ = 0.; // don't update at transition
 
-    if (supportContact.surfaceName == "LeftFootCenter")
+    if (supportContact.surface == ContactSurface::LeftFootCenter)
     {
       ctl.leftFootRatio(1.);
       stabilizer().contactState(ContactState::LeftFoot);
       supportFootTask = stabilizer().leftFootTask;
       swingFootTask = stabilizer().rightFootTask;
     }
-    else // (ctl.supportContact.surfaceName == "RightFootCenter")
+    else // (supportContact.surface == ContactSurface::RightFootCenter)
     {
       ctl.leftFootRatio(0.);
       stabilizer().contactState(ContactState::RightFoot);
@@ -57,45 +58,23 @@ namespace capture_walking
       swingFootTask = stabilizer().leftFootTask;
     }
 
-    swingFoot_.landingPitch(ctl.plan.landingPitch());
-    swingFoot_.landingRatio(ctl.plan.landingRatio());
-    swingFoot_.takeoffPitch(ctl.plan.takeoffPitch());
-    swingFoot_.takeoffRatio(ctl.plan.takeoffRatio());
-    swingFoot_.takeoffOffset(ctl.plan.takeoffOffset());
-    swingFoot_.reset(
+    ctl.swingFoot.landingPitch(ctl.plan.landingPitch());
+    ctl.swingFoot.landingRatio(ctl.plan.landingRatio());
+    ctl.swingFoot.takeoffPitch(ctl.plan.takeoffPitch());
+    ctl.swingFoot.takeoffRatio(ctl.plan.takeoffRatio());
+    ctl.swingFoot.takeoffOffset(ctl.plan.takeoffOffset());
+    ctl.swingFoot.reset(
         swingFootTask->surfacePose(), targetContact.pose,
         duration_, ctl.plan.swingHeight());
     stabilizer().setContact(supportFootTask, supportContact);
     stabilizer().setSwingFoot(swingFootTask);
-    stabilizer().addTasks(ctl.solver());
-
-    logger().addLogEntry("rem_phase_time", [this]() { return remTime_; });
-    logger().addLogEntry("support_xmax", [&ctl]() { return ctl.supportContact().xmax(); });
-    logger().addLogEntry("support_xmin", [&ctl]() { return ctl.supportContact().xmin(); });
-    logger().addLogEntry("support_ymax", [&ctl]() { return ctl.supportContact().ymax(); });
-    logger().addLogEntry("support_ymin", [&ctl]() { return ctl.supportContact().ymin(); });
-    logger().addLogEntry("support_zmax", [&ctl]() { return ctl.supportContact().zmax(); });
-    logger().addLogEntry("support_zmin", [&ctl]() { return ctl.supportContact().zmin(); });
-    logger().addLogEntry("walking_phase", []() { return 1.; });
-    swingFoot_.addLogEntries(logger());
+    ctl.addStabilizerTasks();
 
     runState(); // don't wait till next cycle to update reference and tasks
   }
 
   void states::SingleSupport::teardown()
   {
-    stabilizer().removeTasks(controller().solver());
-
-    logger().removeLogEntry("contact_impulse");
-    logger().removeLogEntry("rem_phase_time");
-    logger().removeLogEntry("support_xmax");
-    logger().removeLogEntry("support_xmin");
-    logger().removeLogEntry("support_ymax");
-    logger().removeLogEntry("support_ymin");
-    logger().removeLogEntry("support_zmax");
-    logger().removeLogEntry("support_zmin");
-    logger().removeLogEntry("walking_phase");
-    swingFoot_.removeLogEntries(logger());
   }
 
   bool states::SingleSupport::checkTransitions()
@@ -114,7 +93,7 @@ namespace capture_walking
     double dt = ctl.timeStep;
 
     updateSwingFoot();
-    if (timeSinceLastPreviewUpdate_ > ctl.previewUpdatePeriod)
+    if (ctl.previewUpdateRequired(timeSinceLastPreviewUpdate_))
     {
       updatePreview();
     }
@@ -127,16 +106,25 @@ namespace capture_walking
         pendulum().resetCoMHeight(ctl.plan.comHeight(), ctl.supportContact());
         pendulum().completeIPM(ctl.supportContact());
       }
-      else // still in DSP of preview
+      else // still in DSP of preview, completed as in DoubleSupport
       {
+        pendulum().resetCoMHeight(ctl.plan.comHeight(), ctl.prevContact());
         pendulum().completeIPM(ctl.prevContact());
       }
     }
-    stabilizer().run();
+    {
+      CycleBudget::ScopedSection section(ctl.cycleBudget, CycleSection::Stabilizer);
+      stabilizer().run();
+    }
 
     remTime_ -= dt;
     stateTime_ += dt;
     timeSinceLastPreviewUpdate_ += dt;
+
+    if (!hasRequestedPresolve_ && remTime_ < ctl.presolver.window())
+    {
+      hasRequestedPresolve_ = ctl.requestPresolve(remTime_);
+    }
   }
 
   void states::SingleSupport::updateSwingFoot()
@@ -151,10 +139,10 @@ namespace capture_walking
       bool touchdownDetected = stabilizer().detectTouchdown(swingFootTask, targetContact);
       if (liftPhase || !touchdownDetected)
       {
-        swingFoot_.integrate(dt);
-        swingFootTask->targetPose(swingFoot_.pose());
-        swingFootTask->refVelB(swingFoot_.vel());
-        swingFootTask->refAccel(swingFoot_.accel());
+        ctl.swingFoot.integrate(dt);
+        swingFootTask->targetPose(ctl.swingFoot.pose());
+        swingFootTask->refVelB(ctl.swingFoot.vel());
+        swingFootTask->refAccel(ctl.swingFoot.accel());
       }
       else // (stabilizer().contactState() != ContactState::DoubleSupport)
       {
@@ -186,6 +174,7 @@ namespace capture_walking
     cps.stepTime(remTime_ + ctl.doubleSupportDuration());
     if (ctl.updatePreviewCPS())
     {
+      hasRequestedPresolve_ = false; // predicted touchdown state changed
       timeSinceLastPreviewUpdate_ = 0.;
     }
   }
@@ -194,7 +183,7 @@ namespace capture_walking
   {
     auto & ctl = controller();
     ctl.hmpc.contacts(ctl.supportContact(), ctl.targetContact(), ctl.nextContact());
-    if (ctl.isLastSSP() || ctl.pauseWalking || ctl.prevContact().pauseAfterSwing)
+    if (ctl.stopAfterSwing())
     {
       ctl.nextDoubleSupportDuration(ctl.plan.finalDSPDuration());
       ctl.hmpc.phaseDurations(remTime_, ctl.plan.finalDSPDuration(), 0.);
@@ -205,6 +194,7 @@ namespace capture_walking
     }
     if (ctl.updatePreviewHMPC())
     {
+      hasRequestedPresolve_ = false; // predicted touchdown state changed
       timeSinceLastPreviewUpdate_ = 0.;
       hasUpdatedMPCOnce_ = true;
     }
@@ -32,7 +32,6 @@
 
 #include <capture_walking/Controller.h>
 #include <capture_walking/State.h>
-#include <capture_walking/SwingFoot.h>
 #include <capture_walking/utils/Interval.h>
 
 namespace capture_walking
@@ -64,6 +63,22 @@ namespace capture_walking
        */
       void runState() override;
 
+      /** Walking phase of this state.
+       *
+       */
+      WalkingPhase phase() const override
+      {
+        return WalkingPhase::SingleSupport;
+      }
+
+      /** Remaining time in the phase.
+       *
+       */
+      double remPhaseTime() const override
+      {
+        return remTime_;
+      }
+
       /** Update swing foot target.
        *
        */
@@ -85,7 +100,7 @@ namespace capture_walking
       void updatePreviewHMPC();
 
     private:
-      SwingFoot swingFoot_;
+      bool hasRequestedPresolve_;
       bool hasUpdatedMPCOnce_;
       double duration_;
       double earlyDoubleSupportDuration_;
@@ -36,6 +36,35 @@ namespace capture_walking
     constexpr double COM_STIFFNESS = 5.; // standing has CoM set-point task
     constexpr double MAX_CPS_FINAL_DSP_DURATION = 0.3; // [s]
     constexpr double MAX_CPS_INIT_DSP_DURATION = 0.3; // [s]
+
+    /** Get Standing state if it is the active one, nullptr otherwise.
+     *
+     * \param ctl Controller.
+     *
+     */
+    states::Standing * activeStanding(Controller & ctl)
+    {
+      return dynamic_cast<states::Standing*>(ctl.activeState());
+    }
+
+    /** Apply a GUI callback to the Standing state if it is active.
+     *
+     * \param ctl Controller.
+     *
+     * \param callback Function taking the Standing state as argument.
+     *
+     */
+    template <typename CallbackT>
+    void ifStanding(Controller & ctl, CallbackT callback)
+    {
+      states::Standing * standing = activeStanding(ctl);
+      if (!standing)
+      {
+        LOG_WARNING("Robot is not standing");
+        return;
+      }
+      callback(*standing);
+    }
   }
 
   void states::Standing::start()
@@ -48,13 +77,14 @@ namespace capture_walking
     isMakingFootContact_ = false;
     leftFootRatio_ = ctl.leftFootRatio();
     releaseHeight_ = 0.05; // [m]
-    startWalking_ = false;
-    if (supportContact.surfaceName == "RightFootCenter")
+    startWalking_ = ctl.waitForFootsteps; // streaming plan was starved
+    ctl.waitForFootsteps = false;
+    if (supportContact.surface == ContactSurface::RightFootCenter)
     {
       leftFootContact_ = targetContact;
       rightFootContact_ = supportContact;
     }
-    else if (supportContact.surfaceName == "LeftFootCenter")
+    else if (supportContact.surface == ContactSurface::LeftFootCenter)
     {
       leftFootContact_ = supportContact;
       rightFootContact_ = targetContact;
@@ -62,140 +92,124 @@ namespace capture_walking
     else
     {
       LOG_ERROR_AND_THROW(std::invalid_argument,
-          "Unknown surface name: " << supportContact.surfaceName);
+          "Unknown surface for support contact " << supportContact.id);
     }
 
     stabilizer().contactState(ContactState::DoubleSupport);
     stabilizer().setContact(stabilizer().leftFootTask, leftFootContact_);
     stabilizer().setContact(stabilizer().rightFootTask, rightFootContact_);
-    stabilizer().addTasks(ctl.solver());
+    ctl.addStabilizerTasks();
 
     updateTarget(leftFootRatio_);
-
-    logger().addLogEntry("support_xmax", [&ctl]() { return std::max(ctl.supportContact().xmax(), ctl.targetContact().xmax()); });
-    logger().addLogEntry("support_xmin", [&ctl]() { return std::min(ctl.supportContact().xmin(), ctl.targetContact().xmin()); });
-    logger().addLogEntry("support_ymax", [&ctl]() { return std::max(ctl.supportContact().ymax(), ctl.targetContact().ymax()); });
-    logger().addLogEntry("support_ymin", [&ctl]() { return std::min(ctl.supportContact().ymin(), ctl.targetContact().ymin()); });
-    logger().addLogEntry("support_zmax", [&ctl]() { return std::max(ctl.supportContact().zmax(), ctl.targetContact().zmax()); });
-    logger().addLogEntry("support_zmin", [&ctl]() { return std::min(ctl.supportContact().zmin(), ctl.targetContact().zmin()); });
-    logger().addLogEntry("walking_phase", []() { return 3.; });
     ctl.stopLogSegment();
 
-    if (gui())
-    {
-      using namespace mc_rtc::gui;
-      gui()->removeElement({"Walking", "Controller"}, "Pause walking");
-      if (!ctl.isLastDSP())
-      {
-        gui()->addElement(
-          {"Walking", "Controller"},
-          Button(
-            (supportContact.id == 0) ? "Start walking" : "Resume walking",
-            [this]()
-            {
-              auto & ctl = controller();
-              if (ctl.isLastSSP())
-              {
-                LOG_ERROR("No footstep in contact plan");
-                return;
-              }
-              if (ctl.wpg == WalkingPatternGeneration::CaptureProblem)
-              {
-                if (ctl.plan.initDSPDuration() > MAX_CPS_INIT_DSP_DURATION)
-                {
-                  LOG_WARNING("Initial DSP duration cut to " << MAX_CPS_INIT_DSP_DURATION << " [s] for CPS");
-                  ctl.plan.initDSPDuration(MAX_CPS_INIT_DSP_DURATION);
-                }
-                if (ctl.plan.finalDSPDuration() > MAX_CPS_FINAL_DSP_DURATION)
-                {
-                  LOG_WARNING("Final DSP duration cut to " << MAX_CPS_FINAL_DSP_DURATION << " [s] for CPS");
-                  ctl.plan.finalDSPDuration(MAX_CPS_FINAL_DSP_DURATION);
-                }
-              }
-              startWalking_ = true;
-              gui()->addElement(
-                  {"Walking", "Controller"},
-                  mc_rtc::gui::Button(
-                      "Pause walking",
-                      [&ctl]()
-                      {
-                        if (ctl.pauseWalking)
-                        {
-                          return;
-                        }
-                        ctl.pauseWalking = true;
-                        ctl.gui()->removeElement({"Walking", "Controller"}, "Pause walking");
-                      }));
-            }));
-      }
-      gui()->addElement(
-        {"Walking", "Standing"},
-        NumberInput(
-          "CoM target [0-1]",
-          [this]() { return std::round(leftFootRatio_ * 10.) / 10.; },
-          [this](double leftFootRatio) { updateTarget(leftFootRatio); }),
-        NumberInput(
-          "Free foot gain",
-          [this]() { return std::round(freeFootGain_); },
-          [this](double gain) { freeFootGain_ = clamp(gain, 5., 100.); }),
-        NumberInput(
-          "Release height [m]",
-          [this]() { return std::round(releaseHeight_ * 100.) / 100.; },
-          [this](double height) { releaseHeight_ = clamp(height, 0., 0.25); }),
-        Label(
-          "Left foot pressure [N]",
-          [&ctl]() { return ctl.realRobot().forceSensor("LeftFootForceSensor").force().z(); }),
-        Label(
-          "Right foot pressure [N]",
-          [&ctl]() { return ctl.realRobot().forceSensor("RightFootForceSensor").force().z(); }),
-        Button(
-          "Go to left foot",
-          [this]() { updateTarget(1.); }),
-        Button(
-          "Go to middle",
-          [this]() { updateTarget(0.5); }),
-        Button(
-          "Go to right foot",
-          [this]() { updateTarget(0.); }),
-        Button(
-          "Make left foot contact",
-          [this]() { makeLeftFootContact(); }),
-        Button(
-          "Make right foot contact",
-          [this]() { makeRightFootContact(); }),
-        Button(
-          "Release left foot",
-          [this]() { releaseLeftFootContact(); }),
-        Button(
-          "Release right foot",
-          [this]() { releaseRightFootContact(); })
-      );
-    }
-
     runState(); // don't wait till next cycle to update reference and tasks
   }
 
-  void states::Standing::teardown()
+  void states::Standing::addGUIElements()
   {
+    if (!gui())
+    {
+      return;
+    }
+    using namespace mc_rtc::gui;
     auto & ctl = controller();
+    gui()->addElement(
+      {"Walking", "Controller"},
+      Button(
+        "Start walking",
+        [&ctl]() { ifStanding(ctl, [](states::Standing & standing) { standing.startWalking(); }); }));
+    gui()->addElement(
+      {"Walking", "Standing"},
+      NumberInput(
+        "CoM target [0-1]",
+        [&ctl]()
+        {
+          states::Standing * standing = activeStanding(ctl);
+          return (standing) ? std::round(standing->leftFootRatio() * 10.) / 10. : 0.;
+        },
+        [&ctl](double leftFootRatio) { ifStanding(ctl, [leftFootRatio](states::Standing & standing) { standing.updateTarget(leftFootRatio); }); }),
+      NumberInput(
+        "Free foot gain",
+        [&ctl]()
+        {
+          states::Standing * standing = activeStanding(ctl);
+          return (standing) ? std::round(standing->freeFootGain()) : 0.;
+        },
+        [&ctl](double gain) { ifStanding(ctl, [gain](states::Standing & standing) { standing.freeFootGain(clamp(gain, 5., 100.)); }); }),
+      NumberInput(
+        "Release height [m]",
+        [&ctl]()
+        {
+          states::Standing * standing = activeStanding(ctl);
+          return (standing) ? std::round(standing->releaseHeight() * 100.) / 100. : 0.;
+        },
+        [&ctl](double height) { ifStanding(ctl, [height](states::Standing & standing) { standing.releaseHeight(clamp(height, 0., 0.25)); }); }),
+      Label(
+        "Left foot pressure [N]",
+        [&ctl]() { return ctl.sensorFrame().leftFoot.pressure; }),
+      Label(
+        "Right foot pressure [N]",
+        [&ctl]() { return ctl.sensorFrame().rightFoot.pressure; }),
+      Button(
+        "Go to left foot",
+        [&ctl]() { ifStanding(ctl, [](states::Standing & standing) { standing.updateTarget(1.); }); }),
+      Button(
+        "Go to middle",
+        [&ctl]() { ifStanding(ctl, [](states::Standing & standing) { standing.updateTarget(0.5); }); }),
+      Button(
+        "Go to right foot",
+        [&ctl]() { ifStanding(ctl, [](states::Standing & standing) { standing.updateTarget(0.); }); }),
+      Button(
+        "Make left foot contact",
+        [&ctl]() { ifStanding(ctl, [](states::Standing & standing) { standing.makeLeftFootContact(); }); }),
+      Button(
+        "Make right foot contact",
+        [&ctl]() { ifStanding(ctl, [](states::Standing & standing) { standing.makeRightFootContact(); }); }),
+      Button(
+        "Release left foot",
+        [&ctl]() { ifStanding(ctl, [](states::Standing & standing) { standing.releaseLeftFootContact(); }); }),
+      Button(
+        "Release right foot",
+        [&ctl]() { ifStanding(ctl, [](states::Standing & standing) { standing.releaseRightFootContact(); }); })
+    );
+  }
 
-    stabilizer().removeTasks(ctl.solver());
-
-    logger().removeLogEntry("support_xmax");
-    logger().removeLogEntry("support_xmin");
-    logger().removeLogEntry("support_ymax");
-    logger().removeLogEntry("support_ymin");
-    logger().removeLogEntry("support_zmax");
-    logger().removeLogEntry("support_zmin");
-    logger().removeLogEntry("walking_phase");
+  void states::Standing::teardown()
+  {
+  }
 
-    if (gui())
+  void states::Standing::startWalking()
+  {
+    auto & ctl = controller();
+    if (ctl.plan.isStreaming() && (ctl.isLastDSP() || ctl.isLastSSP()))
     {
-      gui()->removeCategory({"Walking", "Standing"});
-      gui()->removeElement({"Walking", "Controller"}, "Go to middle");
-      gui()->removeElement({"Walking", "Controller"}, "Start walking");
-      gui()->removeElement({"Walking", "Controller"}, "Resume walking");
+      LOG_INFO("Waiting for streamed footsteps to start walking");
     }
+    else if (ctl.isLastDSP())
+    {
+      LOG_ERROR("End of footstep plan reached, reset to walk again");
+      return;
+    }
+    else if (ctl.isLastSSP())
+    {
+      LOG_ERROR("No footstep in contact plan");
+      return;
+    }
+    if (ctl.wpg == WalkingPatternGeneration::CaptureProblem)
+    {
+      if (ctl.plan.initDSPDuration() > MAX_CPS_INIT_DSP_DURATION)
+      {
+        LOG_WARNING("Initial DSP duration cut to " << MAX_CPS_INIT_DSP_DURATION << " [s] for CPS");
+        ctl.plan.initDSPDuration(MAX_CPS_INIT_DSP_DURATION);
+      }
+      if (ctl.plan.finalDSPDuration() > MAX_CPS_FINAL_DSP_DURATION)
+      {
+        LOG_WARNING("Final DSP duration cut to " << MAX_CPS_FINAL_DSP_DURATION << " [s] for CPS");
+        ctl.plan.finalDSPDuration(MAX_CPS_FINAL_DSP_DURATION);
+      }
+    }
+    startWalking_ = true;
   }
 
   void states::Standing::runState()
@@ -241,7 +255,10 @@ namespace capture_walking
 
     pendulum().integrateIPM(zmp, lambda, ctl.timeStep);
     ctl.leftFootRatio(leftFootRatio_);
-    ctl.stabilizer().run();
+    {
+      CycleBudget::ScopedSection section(ctl.cycleBudget, CycleSection::Stabilizer);
+      ctl.stabilizer().run();
+    }
   }
 
   void states::Standing::updateTarget(double leftFootRatio)
@@ -251,7 +268,7 @@ namespace capture_walking
       LOG_ERROR("Cannot update CoM target while in single support");
       return;
     }
-    leftFootRatio = clamp(leftFootRatio, 0., 1., "Standing target");
+    leftFootRatio = CW_CLAMP(leftFootRatio, 0., 1., "Standing target");
     sva::PTransformd X_0_mid = sva::interpolate(rightFootContact_.anklePose(), leftFootContact_.anklePose(), leftFootRatio);
     copTarget_ = X_0_mid.translation();
     leftFootRatio_ = leftFootRatio;
@@ -291,7 +308,7 @@ namespace capture_walking
       LOG_WARNING("Foot contact is already released");
       return false;
     }
-    else if (footTask->measuredWrench().force().z() > MAX_FOOT_RELEASE_PRESSURE)
+    else if (stabilizer.measuredPressure(footTask) > MAX_FOOT_RELEASE_PRESSURE)
     {
       LOG_ERROR("Contact pressure is too high to release foot");
       return false;
@@ -327,6 +344,10 @@ namespace capture_walking
     {
       return false;
     }
+    if (ctl.isLastDSP() || ctl.isLastSSP())
+    {
+      return false; // streaming plan is waiting for footsteps
+    }
     if (ctl.wpg == WalkingPatternGeneration::CaptureProblem)
     {
       ctl.cps.contacts(ctl.supportContact(), ctl.targetContact());
@@ -54,6 +54,11 @@ namespace capture_walking
        */
       void start() override;
 
+      /** Add "Start walking" button and standing GUI elements.
+       *
+       */
+      void addGUIElements() override;
+
       /** Teardown state.
        *
        */
@@ -69,6 +74,63 @@ namespace capture_walking
        */
       void runState() override;
 
+      /** Walking phase of this state.
+       *
+       */
+      WalkingPhase phase() const override
+      {
+        return WalkingPhase::Standing;
+      }
+
+      /** Request transition to walking, if the footstep plan allows it.
+       *
+       */
+      void startWalking();
+
+      /** Get stiffness of the free foot.
+       *
+       */
+      double freeFootGain() const
+      {
+        return freeFootGain_;
+      }
+
+      /** Set stiffness of the free foot.
+       *
+       * \param gain New stiffness.
+       *
+       */
+      void freeFootGain(double gain)
+      {
+        freeFootGain_ = gain;
+      }
+
+      /** Get left foot weight index of the CoM target.
+       *
+       */
+      double leftFootRatio() const
+      {
+        return leftFootRatio_;
+      }
+
+      /** Get height by which a foot is lifted when released.
+       *
+       */
+      double releaseHeight() const
+      {
+        return releaseHeight_;
+      }
+
+      /** Set height by which a foot is lifted when released.
+       *
+       * \param height New height in [m].
+       *
+       */
+      void releaseHeight(double height)
+      {
+        releaseHeight_ = height;
+      }
+
       /** Distribute spatial ZMP into foot CoPs in double support.
        *
        */
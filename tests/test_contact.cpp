@@ -0,0 +1,111 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/** Unit test of contact geometry.
+ *
+ * Usage:
+ *
+ *     test_contact
+ *
+ * Checks that precomputed geometry follows yawed contacts when they are
+ * translated, as by drift or noise.
+ *
+ */
+
+#include <cstdlib>
+#include <iostream>
+
+#include <capture_walking/Contact.h>
+
+namespace
+{
+  using capture_walking::Contact;
+  using capture_walking::ContactSurface;
+
+  unsigned nbFailures = 0;
+
+  void check(bool condition, const char * description)
+  {
+    if (!condition)
+    {
+      std::cerr << "FAILED: " << description << std::endl;
+      nbFailures++;
+    }
+  }
+
+  Contact makeYawedContact(double yaw)
+  {
+    Contact contact;
+    contact.halfLength = 0.112; // [m]
+    contact.halfWidth = 0.065; // [m]
+    contact.surface = ContactSurface::LeftFootCenter;
+    contact.pose = sva::PTransformd(sva::RotZ(yaw), Eigen::Vector3d{0.3, 0.1, 0.});
+    contact.updateGeometry();
+    return contact;
+  }
+
+  void checkGeometry(const Contact & contact, const char * description)
+  {
+    Contact fresh = contact;
+    fresh.updateGeometry();
+    bool isConsistent = contact.geometry.hrepMat.isApprox(fresh.geometry.hrepMat)
+      && contact.geometry.hrepVec.isApprox(fresh.geometry.hrepVec)
+      && contact.geometry.anklePos.isApprox(fresh.geometry.anklePos);
+    check(isConsistent, description);
+  }
+
+  void testTranslateYawedContact()
+  {
+    for (double yaw : {0., 0.3, -1.2, 2.5})
+    {
+      Contact contact = makeYawedContact(yaw);
+      contact.translate({0.02, -0.01, 0.005});
+      checkGeometry(contact, "geometry of a translated yawed contact");
+    }
+  }
+
+  void testNoiseOnYawedContact()
+  {
+    Contact contact = makeYawedContact(0.8);
+    for (unsigned i = 0; i < 10; i++)
+    {
+      checkGeometry(contact.addNoise(0.01), "geometry of a noised yawed contact");
+    }
+  }
+}
+
+int main()
+{
+  testTranslateYawedContact();
+  testNoiseOnYawedContact();
+  if (nbFailures > 0)
+  {
+    std::cerr << nbFailures << " check(s) failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "All checks passed" << std::endl;
+  return EXIT_SUCCESS;
+}
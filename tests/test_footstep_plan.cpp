@@ -0,0 +1,169 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/** Unit test of streaming footstep plans.
+ *
+ * Usage:
+ *
+ *     test_footstep_plan
+ *
+ * Checks that contacts appended to a starved streaming plan become the
+ * target or next contact, both before and during a walk.
+ *
+ */
+
+#include <cstdlib>
+#include <iostream>
+
+#include <capture_walking/FootstepPlan.h>
+
+namespace
+{
+  using capture_walking::Contact;
+  using capture_walking::ContactSurface;
+  using capture_walking::FootstepPlan;
+
+  unsigned nbFailures = 0;
+
+  void check(bool condition, const char * description)
+  {
+    if (!condition)
+    {
+      std::cerr << "FAILED: " << description << std::endl;
+      nbFailures++;
+    }
+  }
+
+  bool isLastSSP(const FootstepPlan & plan)
+  {
+    return (plan.targetContact().id > plan.nextContact().id);
+  }
+
+  bool isLastDSP(const FootstepPlan & plan)
+  {
+    return (plan.supportContact().id > plan.targetContact().id);
+  }
+
+  Contact makeContact(unsigned i)
+  {
+    Contact contact;
+    contact.halfLength = 0.112; // [m]
+    contact.halfWidth = 0.065; // [m]
+    contact.surface = (i % 2 == 0) ? ContactSurface::RightFootCenter : ContactSurface::LeftFootCenter;
+    contact.pose = Eigen::Vector3d{0.2 * (i / 2), (i % 2 == 0) ? -0.1 : 0.1, 0.};
+    return contact;
+  }
+
+  FootstepPlan makeStreamingPlan()
+  {
+    capture_walking::PlanRecord record = {};
+    record.comHeight = 0.78; // [m]
+    record.doubleSupportDuration = 0.2; // [s]
+    record.singleSupportDuration = 0.8; // [s]
+    record.isStreaming = 1;
+    FootstepPlan plan;
+    plan.load(record, nullptr);
+    plan.appendContact(makeContact(0));
+    plan.appendContact(makeContact(1));
+    plan.reset();
+    return plan;
+  }
+
+  void testAppendBeforeWalking()
+  {
+    FootstepPlan plan = makeStreamingPlan();
+    check(isLastSSP(plan), "plan with feet contacts only is starved");
+    plan.appendContact(makeContact(2));
+    check(!isLastSSP(plan), "appended contact ends starvation before walking");
+    check(plan.nextContact().id == 2, "appended contact becomes next contact");
+    plan.goToNextFootstep();
+    check(plan.supportContact().id == 1, "support contact after first step");
+    check(plan.targetContact().id == 2, "appended contact becomes target contact");
+    check(plan.targetContact().pose.translation().isApprox(makeContact(2).pose.translation()), "target contact pose");
+  }
+
+  void testAppendDuringLastStep()
+  {
+    FootstepPlan plan = makeStreamingPlan();
+    plan.appendContact(makeContact(2));
+    plan.goToNextFootstep();
+    check(isLastSSP(plan), "plan is starved during last step");
+    plan.appendContact(makeContact(3));
+    check(!isLastSSP(plan), "appended contact ends starvation during last step");
+    check(plan.nextContact().id == 3, "appended contact becomes next contact during step");
+    plan.goToNextFootstep();
+    check(plan.targetContact().id == 3, "next contact becomes target contact");
+  }
+
+  void testAppendAfterLastStep()
+  {
+    FootstepPlan plan = makeStreamingPlan();
+    plan.appendContact(makeContact(2));
+    plan.goToNextFootstep();
+    plan.goToNextFootstep();
+    check(isLastDSP(plan), "plan is starved after last step");
+    plan.appendContact(makeContact(3));
+    check(!isLastDSP(plan), "appended contact ends starvation after last step");
+    check(plan.targetContact().id == 3, "appended contact becomes target contact after last step");
+    plan.appendContact(makeContact(4));
+    check(plan.nextContact().id == 4, "second appended contact becomes next contact");
+    plan.goToNextFootstep();
+    check(plan.supportContact().id == 3, "walk resumes on appended contacts");
+    check(plan.targetContact().id == 4, "target contact after resuming");
+  }
+
+  void testAppendWhileStanding()
+  {
+    FootstepPlan plan = makeStreamingPlan();
+    plan.appendContact(makeContact(2));
+    plan.goToNextFootstep();
+    plan.goToNextFootstep();
+    plan.restorePreviousFootstep(); // final DSP to Standing
+    check(plan.supportContact().id == 1, "support contact while standing");
+    check(plan.targetContact().id == 2, "target contact while standing");
+    check(isLastSSP(plan), "plan is starved while standing");
+    plan.appendContact(makeContact(3));
+    check(!isLastSSP(plan), "appended contact ends starvation while standing");
+    plan.goToNextFootstep(); // Standing to DoubleSupport
+    check(plan.supportContact().id == 2, "support contact after standing");
+    check(plan.targetContact().id == 3, "target contact after standing");
+  }
+}
+
+int main()
+{
+  testAppendBeforeWalking();
+  testAppendDuringLastStep();
+  testAppendAfterLastStep();
+  testAppendWhileStanding();
+  if (nbFailures > 0)
+  {
+    std::cerr << nbFailures << " check(s) failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "All checks passed" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,278 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** Reconstruct full time series from a controller change log.
+ *
+ * Usage:
+ *
+ *     changelog_reconstruct <changes.csv> <output.csv> --dt <period> [--end <time>]
+ *     changelog_reconstruct <changes.csv> <output.csv> --join <log.csv> [--time-column <name>]
+ *
+ * The first form samples every logged value on a regular time grid. The
+ * second form appends the values to each row of a CSV log, e.g. converted by
+ * mc_bin_to_log, matching rows by their controller time (column "ctl_time" by
+ * default). In both cases a value holds from its change event until the next
+ * one, and cells before the first event are left empty.
+ *
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  struct Event
+  {
+    double time;
+    std::vector<double> values;
+  };
+
+  struct Series
+  {
+    std::vector<Event> events;
+    size_t cursor = 0;
+    size_t size = 0;
+  };
+
+  using SeriesMap = std::map<std::string, Series>;
+
+  std::vector<std::string> split(const std::string & line, char sep = ',')
+  {
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, sep))
+    {
+      fields.push_back(field);
+    }
+    return fields;
+  }
+
+  bool readChanges(const char * path, SeriesMap & series)
+  {
+    std::ifstream file(path);
+    if (!file)
+    {
+      std::cerr << "Cannot open " << path << std::endl;
+      return false;
+    }
+    std::string line;
+    std::getline(file, line); // header
+    while (std::getline(file, line))
+    {
+      std::vector<std::string> fields = split(line);
+      if (fields.size() < 3)
+      {
+        continue;
+      }
+      Event event;
+      event.time = std::atof(fields[0].c_str());
+      for (size_t i = 2; i < fields.size(); i++)
+      {
+        event.values.push_back(std::atof(fields[i].c_str()));
+      }
+      Series & s = series[fields[1]];
+      s.size = std::max(s.size, event.values.size());
+      s.events.push_back(event);
+    }
+    return true;
+  }
+
+  std::string header(const SeriesMap & series)
+  {
+    std::string line;
+    for (const auto & it : series)
+    {
+      for (size_t i = 0; i < it.second.size; i++)
+      {
+        line += "," + it.first;
+        if (it.second.size > 1)
+        {
+          line += "_" + std::to_string(i);
+        }
+      }
+    }
+    return line;
+  }
+
+  /** Values at a given time. Times are assumed non-decreasing between calls.
+   *
+   */
+  std::string valuesAt(SeriesMap & series, double time)
+  {
+    std::string line;
+    char buffer[32];
+    for (auto & it : series)
+    {
+      Series & s = it.second;
+      while (s.cursor + 1 < s.events.size() && s.events[s.cursor + 1].time <= time)
+      {
+        s.cursor++;
+      }
+      bool isSet = (!s.events.empty() && s.events[s.cursor].time <= time);
+      for (size_t i = 0; i < s.size; i++)
+      {
+        line += ",";
+        if (isSet && i < s.events[s.cursor].values.size())
+        {
+          std::snprintf(buffer, sizeof(buffer), "%.9g", s.events[s.cursor].values[i]);
+          line += buffer;
+        }
+      }
+    }
+    return line;
+  }
+
+  int resample(SeriesMap & series, std::ofstream & output, double dt, double end)
+  {
+    if (dt <= 0.)
+    {
+      std::cerr << "Sampling period must be positive" << std::endl;
+      return 1;
+    }
+    output << "time" << header(series) << "\n";
+    for (unsigned k = 0; k * dt <= end + 1e-9; k++)
+    {
+      double time = k * dt;
+      output << time << valuesAt(series, time) << "\n";
+    }
+    return 0;
+  }
+
+  int join(SeriesMap & series, std::ofstream & output, const char * logPath, const std::string & timeColumn)
+  {
+    std::ifstream log(logPath);
+    if (!log)
+    {
+      std::cerr << "Cannot open " << logPath << std::endl;
+      return 1;
+    }
+    std::string line;
+    std::getline(log, line);
+    std::vector<std::string> columns = split(line);
+    size_t timeIndex = columns.size();
+    for (size_t i = 0; i < columns.size(); i++)
+    {
+      if (columns[i] == timeColumn)
+      {
+        timeIndex = i;
+      }
+    }
+    if (timeIndex == columns.size())
+    {
+      std::cerr << "No column \"" << timeColumn << "\" in " << logPath << std::endl;
+      return 1;
+    }
+    output << line << header(series) << "\n";
+    while (std::getline(log, line))
+    {
+      std::vector<std::string> fields = split(line);
+      double time = (timeIndex < fields.size()) ? std::atof(fields[timeIndex].c_str()) : 0.;
+      output << line << valuesAt(series, time) << "\n";
+    }
+    return 0;
+  }
+
+  void usage(const char * name)
+  {
+    std::cerr << "Usage: " << name << " <changes.csv> <output.csv> --dt <period> [--end <time>]" << std::endl;
+    std::cerr << "       " << name << " <changes.csv> <output.csv> --join <log.csv> [--time-column <name>]" << std::endl;
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  if (argc < 5)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+  double dt = -1.;
+  double end = -1.;
+  const char * logPath = nullptr;
+  std::string timeColumn = "ctl_time";
+  for (int i = 3; i + 1 < argc; i += 2)
+  {
+    if (std::strcmp(argv[i], "--dt") == 0)
+    {
+      dt = std::atof(argv[i + 1]);
+    }
+    else if (std::strcmp(argv[i], "--end") == 0)
+    {
+      end = std::atof(argv[i + 1]);
+    }
+    else if (std::strcmp(argv[i], "--join") == 0)
+    {
+      logPath = argv[i + 1];
+    }
+    else if (std::strcmp(argv[i], "--time-column") == 0)
+    {
+      timeColumn = argv[i + 1];
+    }
+    else
+    {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  SeriesMap series;
+  if (!readChanges(argv[1], series))
+  {
+    return 1;
+  }
+  std::ofstream output(argv[2]);
+  if (!output)
+  {
+    std::cerr << "Cannot open " << argv[2] << " for writing" << std::endl;
+    return 1;
+  }
+  output.precision(9);
+  if (logPath)
+  {
+    return join(series, output, logPath, timeColumn);
+  }
+  if (end < 0.)
+  {
+    for (const auto & it : series)
+    {
+      if (!it.second.events.empty())
+      {
+        end = std::max(end, it.second.events.back().time);
+      }
+    }
+  }
+  return resample(series, output, dt, end);
+}
@@ -0,0 +1,155 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** Stand-in for an external footstep planner.
+ *
+ * Usage:
+ *
+ *     footstep_producer [--socket <path>] [--steps <n>] [--length <m>] [--width <m>] [--yaw-rate <rad>] [--period <s>]
+ *
+ * Streams footsteps of a straight (or circular, with a non-zero yaw rate)
+ * walk to a controller running a streaming plan. The walk starts from the
+ * double-support stance of the "streaming" plan, i.e. feet at x = 0 and
+ * y = +/- width / 2, and swings the right foot first. With zero steps (the
+ * default), footsteps are produced until the program is interrupted. Sending
+ * blocks while the controller's plan is full.
+ *
+ */
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include <capture_walking/StreamedFootstep.h>
+
+using namespace capture_walking;
+
+namespace
+{
+  void usage(const char * program)
+  {
+    std::fprintf(stderr, "Usage: %s [--socket <path>] [--steps <n>] [--length <m>] [--width <m>] [--yaw-rate <rad>] [--period <s>]\n", program);
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  const char * path = FOOTSTEP_STREAM_SOCKET;
+  double length = 0.2; // [m]
+  double period = 0.; // [s]
+  double width = 0.18; // [m]
+  double yawRate = 0.; // [rad] per step
+  long nbSteps = 0;
+  for (int i = 1; i + 1 < argc; i += 2)
+  {
+    if (std::strcmp(argv[i], "--socket") == 0)
+    {
+      path = argv[i + 1];
+    }
+    else if (std::strcmp(argv[i], "--steps") == 0)
+    {
+      nbSteps = std::atol(argv[i + 1]);
+    }
+    else if (std::strcmp(argv[i], "--length") == 0)
+    {
+      length = std::atof(argv[i + 1]);
+    }
+    else if (std::strcmp(argv[i], "--width") == 0)
+    {
+      width = std::atof(argv[i + 1]);
+    }
+    else if (std::strcmp(argv[i], "--yaw-rate") == 0)
+    {
+      yawRate = std::atof(argv[i + 1]);
+    }
+    else if (std::strcmp(argv[i], "--period") == 0)
+    {
+      period = std::atof(argv[i + 1]);
+    }
+    else
+    {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (argc % 2 == 0)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  int fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+  if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+  {
+    std::fprintf(stderr, "Cannot connect to %s: %s\n", path, std::strerror(errno));
+    return 1;
+  }
+
+  // Walk along the mid-line between the feet, starting from the initial stance
+  double x = 0.;
+  double y = 0.;
+  double yaw = 0.;
+  for (long step = 0; nbSteps <= 0 || step < nbSteps; step++)
+  {
+    bool isLeft = (step % 2 == 1);
+    yaw += yawRate;
+    x += length * std::cos(yaw);
+    y += length * std::sin(yaw);
+    double side = isLeft ? +0.5 * width : -0.5 * width;
+    StreamedFootstep footstep;
+    footstep.surface = isLeft ? 1 : 2;
+    footstep.position[0] = x - side * std::sin(yaw);
+    footstep.position[1] = y + side * std::cos(yaw);
+    footstep.rpy[2] = yaw;
+    if (::send(fd, &footstep, sizeof(footstep), 0) < 0)
+    {
+      std::fprintf(stderr, "Cannot send footstep %ld: %s\n", step, std::strerror(errno));
+      ::close(fd);
+      return 1;
+    }
+    std::printf("footstep %ld: %s foot at (%.3f, %.3f), yaw %.3f\n", step, isLeft ? "left" : "right", footstep.position[0], footstep.position[1], yaw);
+    std::fflush(stdout);
+    if (period > 0.)
+    {
+      std::this_thread::sleep_for(std::chrono::duration<double>(period));
+    }
+  }
+  ::close(fd);
+  return 0;
+}
@@ -0,0 +1,173 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** Convert constant-schema log segments to per-segment time columns.
+ *
+ * Usage:
+ *
+ *     log_segments <log.csv> <segment_labels.csv> <output.csv>
+ *
+ * The input is a CSV log, e.g. converted by mc_bin_to_log, with the
+ * "segment_id" and "segment_label" columns written by the controller. Labels
+ * are decoded with the capture_walking-segment-labels-<timestamp>.csv file
+ * written by the same run. The output is the same log with one extra
+ * "t_<id>_<label>" column per segment, equal to the controller time during
+ * that segment and empty elsewhere.
+ * These columns can be used as X axes in mc_log_ui as before.
+ *
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  std::vector<std::string> split(const std::string & line, char sep = ',')
+  {
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, sep))
+    {
+      fields.push_back(field);
+    }
+    return fields;
+  }
+
+  int findColumn(const std::vector<std::string> & columns, const std::string & name)
+  {
+    for (unsigned i = 0; i < columns.size(); i++)
+    {
+      if (columns[i] == name)
+      {
+        return static_cast<int>(i);
+      }
+    }
+    return -1;
+  }
+
+  std::string field(const std::vector<std::string> & fields, int index)
+  {
+    return (index >= 0 && static_cast<unsigned>(index) < fields.size()) ? fields[static_cast<unsigned>(index)] : "";
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  if (argc < 4)
+  {
+    std::cerr << "Usage: " << argv[0] << " <log.csv> <segment_labels.csv> <output.csv>" << std::endl;
+    return 1;
+  }
+
+  std::map<int, std::string> labels;
+  std::ifstream labelFile(argv[2]);
+  if (!labelFile)
+  {
+    std::cerr << "Cannot open " << argv[2] << std::endl;
+    return 1;
+  }
+  std::string line;
+  std::getline(labelFile, line); // header
+  while (std::getline(labelFile, line))
+  {
+    size_t comma = line.find(',');
+    if (comma != std::string::npos)
+    {
+      labels[std::atoi(line.substr(0, comma).c_str())] = line.substr(comma + 1);
+    }
+  }
+
+  // First pass: list segments
+  std::ifstream log(argv[1]);
+  if (!log)
+  {
+    std::cerr << "Cannot open " << argv[1] << std::endl;
+    return 1;
+  }
+  std::getline(log, line);
+  std::vector<std::string> columns = split(line);
+  int idColumn = findColumn(columns, "segment_id");
+  int labelColumn = findColumn(columns, "segment_label");
+  int timeColumn = findColumn(columns, "ctl_time");
+  if (idColumn < 0 || labelColumn < 0 || timeColumn < 0)
+  {
+    std::cerr << "Log needs ctl_time, segment_id and segment_label columns" << std::endl;
+    return 1;
+  }
+  std::map<unsigned, std::string> segmentColumns; // segment id -> column name
+  while (std::getline(log, line))
+  {
+    std::vector<std::string> fields = split(line);
+    unsigned id = static_cast<unsigned>(std::atoi(field(fields, idColumn).c_str()));
+    if (id > 0 && segmentColumns.find(id) == segmentColumns.end())
+    {
+      int labelIndex = std::atoi(field(fields, labelColumn).c_str());
+      auto label = labels.find(labelIndex);
+      std::ostringstream name;
+      name << "t_" << std::setw(2) << std::setfill('0') << id << "_" << ((label != labels.end()) ? label->second : std::to_string(labelIndex));
+      segmentColumns[id] = name.str();
+    }
+  }
+
+  // Second pass: append segment columns
+  log.clear();
+  log.seekg(0);
+  std::ofstream output(argv[3]);
+  if (!output)
+  {
+    std::cerr << "Cannot open " << argv[3] << " for writing" << std::endl;
+    return 1;
+  }
+  std::getline(log, line);
+  output << line;
+  for (const auto & it : segmentColumns)
+  {
+    output << "," << it.second;
+  }
+  output << "\n";
+  while (std::getline(log, line))
+  {
+    std::vector<std::string> fields = split(line);
+    unsigned id = static_cast<unsigned>(std::atoi(field(fields, idColumn).c_str()));
+    std::string time = field(fields, timeColumn);
+    output << line;
+    for (const auto & it : segmentColumns)
+    {
+      output << "," << ((it.first == id) ? time : "");
+    }
+    output << "\n";
+  }
+  std::cout << "Wrote " << segmentColumns.size() << " segment columns to " << argv[3] << std::endl;
+  return 0;
+}
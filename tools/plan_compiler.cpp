@@ -0,0 +1,156 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** Compiler of footstep plans into a binary plan library.
+ *
+ * Usage:
+ *
+ *     plan_compiler <controller.conf> <library.bin>
+ *
+ * Reads the "sole" and "plans" sections of the controller configuration,
+ * completes contacts with sole parameters and writes all plans to a library
+ * that the controller memory-maps at startup (see PlanLibrary). Plans are
+ * stored in the order of the configuration, along with hashes of their
+ * configuration and of the sole so that outdated plans are detected.
+ *
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <mc_rtc/Configuration.h>
+
+#include <capture_walking/FootstepPlan.h>
+#include <capture_walking/PlanRecord.h>
+#include <capture_walking/Sole.h>
+
+using namespace capture_walking;
+
+namespace
+{
+  void usage(const char * program)
+  {
+    std::fprintf(stderr, "Usage: %s <controller.conf> <library.bin>\n", program);
+  }
+
+  void readHMPCWeights(const mc_rtc::Configuration & planConfig, PlanRecord & record)
+  {
+    constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+    record.hmpcJerkWeight = NaN;
+    record.hmpcVelWeights[0] = NaN;
+    record.hmpcVelWeights[1] = NaN;
+    record.hmpcZMPWeight = NaN;
+    if (!planConfig.has("hmpc") || !planConfig("hmpc").has("weights"))
+    {
+      return;
+    }
+    auto weights = planConfig("hmpc")("weights");
+    if (weights.has("jerk"))
+    {
+      record.hmpcJerkWeight = weights("jerk");
+    }
+    if (weights.has("vel"))
+    {
+      Eigen::Vector2d velWeights = weights("vel");
+      record.hmpcVelWeights[0] = velWeights.x();
+      record.hmpcVelWeights[1] = velWeights.y();
+    }
+    if (weights.has("zmp"))
+    {
+      record.hmpcZMPWeight = weights("zmp");
+    }
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  if (argc != 3)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  mc_rtc::Configuration config(argv[1]);
+  if (!config.has("plans") || !config.has("sole"))
+  {
+    std::fprintf(stderr, "%s has no \"plans\" or \"sole\" section\n", argv[1]);
+    return 1;
+  }
+  Sole sole = config("sole");
+  uint64_t soleHash = configurationHash(config("sole").dump());
+  auto plans = config("plans");
+
+  std::vector<PlanRecord> planRecords;
+  std::vector<ContactRecord> contactRecords;
+  for (const std::string & name : plans.keys())
+  {
+    if (name.size() >= PLAN_NAME_SIZE)
+    {
+      std::fprintf(stderr, "Plan name \"%s\" is longer than %u characters\n", name.c_str(), PLAN_NAME_SIZE - 1);
+      return 1;
+    }
+    FootstepPlan plan;
+    plan.load(plans(name));
+    plan.complete(sole);
+    PlanRecord record;
+    std::memset(&record, 0, sizeof(record));
+    std::strncpy(record.name, name.c_str(), PLAN_NAME_SIZE - 1);
+    plan.save(record, contactRecords);
+    readHMPCWeights(plans(name), record);
+    record.planHash = configurationHash(plans(name).dump());
+    record.soleHash = soleHash;
+    planRecords.push_back(record);
+  }
+
+  PlanLibraryHeader header;
+  header.magic = PLAN_LIBRARY_MAGIC;
+  header.version = PLAN_LIBRARY_VERSION;
+  header.nbPlans = static_cast<uint32_t>(planRecords.size());
+  header.nbContacts = static_cast<uint32_t>(contactRecords.size());
+
+  std::FILE * output = std::fopen(argv[2], "wb");
+  if (!output)
+  {
+    std::fprintf(stderr, "Cannot open %s for writing\n", argv[2]);
+    return 1;
+  }
+  bool success = (std::fwrite(&header, sizeof(header), 1, output) == 1);
+  success = success && (std::fwrite(planRecords.data(), sizeof(PlanRecord), planRecords.size(), output) == planRecords.size());
+  success = success && (std::fwrite(contactRecords.data(), sizeof(ContactRecord), contactRecords.size(), output) == contactRecords.size());
+  success = (std::fclose(output) == 0) && success;
+  if (!success)
+  {
+    std::fprintf(stderr, "Cannot write %s\n", argv[2]);
+    return 1;
+  }
+  std::printf("Compiled %u plans with %u contacts into %s\n", header.nbPlans, header.nbContacts, argv[2]);
+  return 0;
+}
@@ -0,0 +1,135 @@
+/* 
+ * Copyright (c) 2018-2019, CNRS-UM LIRMM
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** Read controller telemetry from shared memory.
+ *
+ * Usage:
+ *
+ *     telemetry_reader tail [segment]
+ *     telemetry_reader csv <output.csv> [segment]
+ *
+ * The tail mode prints a summary of the latest record ten times per second.
+ * The csv mode dumps all records currently held in the ring then exits.
+ *
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <capture_walking/TelemetryRecord.h>
+#include <capture_walking/utils/SharedMemoryRing.h>
+
+using namespace capture_walking;
+
+namespace
+{
+  using TelemetryRing = SharedMemoryRing<TelemetryRecord>;
+
+  int dumpCSV(const TelemetryRing & ring, const char * path)
+  {
+    FILE * file = std::fopen(path, "w");
+    if (!file)
+    {
+      std::fprintf(stderr, "Cannot open %s for writing\n", path);
+      return 1;
+    }
+    for (unsigned j = 0; j < TELEMETRY_NB_COLUMNS; j++)
+    {
+      std::fprintf(file, (j > 0) ? ",%s" : "%s", TELEMETRY_COLUMNS[j]);
+    }
+    std::fprintf(file, "\n");
+    uint64_t end = ring.writeCount();
+    uint64_t begin = (end > ring.capacity()) ? end - ring.capacity() : 0;
+    unsigned nbSkipped = 0;
+    TelemetryRecord record;
+    for (uint64_t i = begin; i < end; i++)
+    {
+      if (!ring.read(i, record))
+      {
+        nbSkipped++;
+        continue;
+      }
+      const double * values = reinterpret_cast<const double *>(&record);
+      for (unsigned j = 0; j < TELEMETRY_NB_COLUMNS; j++)
+      {
+        std::fprintf(file, (j > 0) ? ",%.9g" : "%.9g", values[j]);
+      }
+      std::fprintf(file, "\n");
+    }
+    std::fclose(file);
+    std::printf("Wrote %lu records to %s (%u overwritten while reading)\n", static_cast<unsigned long>(end - begin - nbSkipped), path, nbSkipped);
+    return 0;
+  }
+
+  int tail(const TelemetryRing & ring)
+  {
+    TelemetryRecord record;
+    std::printf("%10s %24s %24s %8s %8s\n", "time", "com", "zmp", "dcm_err", "lf_ratio");
+    while (true)
+    {
+      uint64_t count = ring.writeCount();
+      if (count > 0 && ring.read(count - 1, record))
+      {
+        const double * c = record.pendulumCom;
+        const double * z = record.pendulumZMP;
+        double dcmError = 0.;
+        for (unsigned i = 0; i < 3; i++)
+        {
+          double omega = record.pendulumOmega;
+          double diff = (record.pendulumCom[i] + record.pendulumComd[i] / omega) - (record.realCom[i] + record.realComd[i] / omega);
+          dcmError += diff * diff;
+        }
+        std::printf("%10.3f (%6.3f,%6.3f,%6.3f) (%6.3f,%6.3f,%6.3f) %8.4f %8.3f\n", record.time, c[0], c[1], c[2], z[0], z[1], z[2], std::sqrt(dcmError), record.leftFootRatio);
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return 0;
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  if (argc < 2 || (std::strcmp(argv[1], "csv") == 0 && argc < 3))
+  {
+    std::fprintf(stderr, "Usage: %s tail [segment]\n       %s csv <output.csv> [segment]\n", argv[0], argv[0]);
+    return 1;
+  }
+  bool csv = (std::strcmp(argv[1], "csv") == 0);
+  int segmentArg = csv ? 3 : 2;
+  std::string segment = (argc > segmentArg) ? argv[segmentArg] : TELEMETRY_SEGMENT;
+  TelemetryRing ring;
+  if (!ring.attach(segment))
+  {
+    std::fprintf(stderr, "Cannot attach to telemetry segment %s\n", segment.c_str());
+    return 1;
+  }
+  return csv ? dumpCSV(ring, argv[2]) : tail(ring);
+}